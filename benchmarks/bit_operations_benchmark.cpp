@@ -0,0 +1,79 @@
+/**
+ * @file bit_operations_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of the bit array scans across array sizes
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "bit_operations.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief A bit array with about one bit in `sparsity` set
+std::vector<BitWord> RandomBits(size_t bitCount, unsigned int sparsity)
+{
+	std::mt19937 random(1);
+	std::vector<BitWord> words(bitArrayWords(bitCount));
+	for (size_t i = 0; i < bitCount; i++)
+	{
+		if (random() % sparsity == 0)
+			words[i / (CHAR_BIT * sizeof(BitWord))] |= (BitWord)1 << (i % (CHAR_BIT * sizeof(BitWord)));
+	}
+
+	return words;
+}
+
+void BM_PopCountArray(benchmark::State& state)
+{
+	size_t bitCount            = state.range(0);
+	std::vector<BitWord> words = RandomBits(bitCount, 2);
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(popCount(words.data(), bitCount));
+
+	state.SetBytesProcessed(state.iterations() * bitCount / CHAR_BIT);
+}
+BENCHMARK(BM_PopCountArray)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+/// @brief Walk a sparse array such as a set of enabled tasks
+void BM_ForEachSetBit(benchmark::State& state)
+{
+	size_t bitCount            = state.range(0);
+	std::vector<BitWord> words = RandomBits(bitCount, 16);
+
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		forEachSetBit(words.data(), bitCount, [&sum](size_t index) { sum += index; });
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * bitCount / CHAR_BIT);
+}
+BENCHMARK(BM_ForEachSetBit)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+/// @brief Find a free slot in an allocation mask whose only clear bit is the last one
+void BM_FindFirstClearIndex(benchmark::State& state)
+{
+	size_t bitCount = state.range(0);
+	std::vector<BitWord> words(bitArrayWords(bitCount), ~(BitWord)0);
+	words.back() &= ~((BitWord)1 << ((bitCount - 1) % (CHAR_BIT * sizeof(BitWord))));
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(findFirstClearIndex(words.data(), bitCount));
+
+	state.SetBytesProcessed(state.iterations() * bitCount / CHAR_BIT);
+}
+BENCHMARK(BM_FindFirstClearIndex)->RangeMultiplier(8)->Range(64, 1 << 18);
+
+} // namespace
@@ -0,0 +1,81 @@
+/**
+ * @file byte_swap_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of the buffer byte order conversion against a loop of scalar byte reverses
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "bit_operations.h"
+#include "byte_swap.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief The code the buffer conversion replaces, one `reverseEndianness` per element
+template <typename T>
+void BM_ScalarLoop(benchmark::State& state)
+{
+	size_t count = state.range(0);
+	std::vector<T> source(count, (T)0x0123456789ABCDEFull);
+	std::vector<T> destination(count);
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < count; i++)
+			destination[i] = reverseEndianness(source[i]);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+
+template <typename T>
+void BM_ReverseElementBytes(benchmark::State& state)
+{
+	size_t count = state.range(0);
+	std::vector<T> source(count, (T)0x0123456789ABCDEFull);
+	std::vector<T> destination(count);
+
+	for (auto _ : state)
+	{
+		reverseElementBytes<sizeof(T)>(source.data(), destination.data(), count);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+
+/// @brief Converting in place from a buffer that is not aligned to the element size, as a field inside a received packet is
+template <typename T>
+void BM_ReverseElementBytesUnaligned(benchmark::State& state)
+{
+	size_t count = state.range(0);
+	std::vector<uint8_t> buffer(count * sizeof(T) + 1, 0x5A);
+
+	for (auto _ : state)
+	{
+		reverseElementBytes<sizeof(T)>(buffer.data() + 1, buffer.data() + 1, count);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+
+// From a few sensor readings up to a logged block
+BENCHMARK(BM_ScalarLoop<uint16_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ReverseElementBytes<uint16_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ScalarLoop<uint32_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ReverseElementBytes<uint32_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ReverseElementBytesUnaligned<uint32_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ScalarLoop<uint64_t>)->RangeMultiplier(8)->Range(4, 4096);
+BENCHMARK(BM_ReverseElementBytes<uint64_t>)->RangeMultiplier(8)->Range(4, 4096);
+
+} // namespace
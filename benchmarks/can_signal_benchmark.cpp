@@ -0,0 +1,160 @@
+/**
+ * @file can_signal_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of CanMessage decoding and encoding against hand-written bitExtract code
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "bit_operations.h"
+#include "can_signal.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+// A motor controller status frame, all little endian as most of the bus is
+using SpeedSignal       = CanSignal<0, 16, ByteOrder::LittleEndian, false, std::ratio<1, 100>>;
+using TemperatureSignal = CanSignal<16, 8, ByteOrder::LittleEndian, true, std::ratio<1, 2>, std::ratio<-40>>;
+using FlagsSignal       = CanSignal<24, 4>;
+using CurrentSignal     = CanSignal<28, 12, ByteOrder::LittleEndian, true>;
+using VoltageSignal     = CanSignal<40, 16, ByteOrder::LittleEndian, false, std::ratio<1, 10>>;
+using CounterSignal     = CanSignal<56, 8>;
+using Status            = CanMessage<8, SpeedSignal, TemperatureSignal, FlagsSignal, CurrentSignal, VoltageSignal, CounterSignal>;
+
+/// @brief The decoded fields of a status frame
+struct Fields
+{
+	SpeedSignal::Type Speed;
+	TemperatureSignal::Type Temperature;
+	FlagsSignal::Type Flags;
+	CurrentSignal::Type Current;
+	VoltageSignal::Type Voltage;
+	CounterSignal::Type Counter;
+};
+
+/// @brief The number of frames decoded per iteration, enough that the loads are not hoisted out of the loop
+constexpr size_t FrameCount = 256;
+
+std::vector<uint8_t> RandomFrames()
+{
+	std::mt19937 random(1);
+	std::vector<uint8_t> frames(FrameCount * 8);
+	for (uint8_t& byte : frames)
+		byte = (uint8_t)random();
+
+	return frames;
+}
+
+/// @brief The code the signal layouts replace, one load of the frame and a bitExtract and scaling per field
+Fields DecodeByHand(const uint8_t* frame)
+{
+	uint64_t word;
+	memcpy(&word, frame, sizeof(word));
+
+	Fields fields;
+	fields.Speed       = (float)bitExtract(word, 0, 16) * 0.01f;
+	fields.Temperature = (float)(int8_t)bitExtract(word, 16, 8) * 0.5f - 40;
+	fields.Flags       = (uint32_t)bitExtract(word, 24, 4);
+	fields.Current     = (int32_t)((int64_t)(bitExtract(word, 28, 12) << 52) >> 52);
+	fields.Voltage     = (float)bitExtract(word, 40, 16) * 0.1f;
+	fields.Counter     = (uint32_t)bitExtract(word, 56, 8);
+	return fields;
+}
+
+/// @brief Hand-written encoding rounds but does not saturate out of range values the way `CanSignal::Encode` does
+void EncodeByHand(uint8_t* frame, const Fields& fields)
+{
+	uint64_t word = 0;
+	word |= (uint64_t)(uint16_t)(fields.Speed * 100 + 0.5f);
+	word |= (uint64_t)(uint8_t)(int8_t)((fields.Temperature + 40) * 2 + (fields.Temperature + 40 < 0 ? -0.5f : 0.5f)) << 16;
+	word |= (uint64_t)(fields.Flags & 0xF) << 24;
+	word |= (uint64_t)(fields.Current & 0xFFF) << 28;
+	word |= (uint64_t)(uint16_t)(fields.Voltage * 10 + 0.5f) << 40;
+	word |= (uint64_t)(fields.Counter & 0xFF) << 56;
+	memcpy(frame, &word, sizeof(word));
+}
+
+void BM_DecodeByHand(benchmark::State& state)
+{
+	std::vector<uint8_t> frames = RandomFrames();
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FrameCount; i++)
+		{
+			Fields fields = DecodeByHand(&frames[i * 8]);
+			benchmark::DoNotOptimize(fields);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * FrameCount);
+}
+BENCHMARK(BM_DecodeByHand);
+
+void BM_DecodeCanMessage(benchmark::State& state)
+{
+	std::vector<uint8_t> frames = RandomFrames();
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FrameCount; i++)
+		{
+			Fields fields;
+			Status::Decode(&frames[i * 8], fields.Speed, fields.Temperature, fields.Flags, fields.Current, fields.Voltage, fields.Counter);
+			benchmark::DoNotOptimize(fields);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * FrameCount);
+}
+BENCHMARK(BM_DecodeCanMessage);
+
+void BM_EncodeByHand(benchmark::State& state)
+{
+	std::vector<uint8_t> frames = RandomFrames();
+	std::vector<Fields> fields(FrameCount);
+	for (size_t i = 0; i < FrameCount; i++)
+		fields[i] = DecodeByHand(&frames[i * 8]);
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FrameCount; i++)
+			EncodeByHand(&frames[i * 8], fields[i]);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * FrameCount);
+}
+BENCHMARK(BM_EncodeByHand);
+
+void BM_EncodeCanMessage(benchmark::State& state)
+{
+	std::vector<uint8_t> frames = RandomFrames();
+	std::vector<Fields> fields(FrameCount);
+	for (size_t i = 0; i < FrameCount; i++)
+		fields[i] = DecodeByHand(&frames[i * 8]);
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FrameCount; i++)
+		{
+			const Fields& f = fields[i];
+			Status::Encode(&frames[i * 8], f.Speed, f.Temperature, f.Flags, f.Current, f.Voltage, f.Counter);
+		}
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * FrameCount);
+}
+BENCHMARK(BM_EncodeCanMessage);
+
+} // namespace
@@ -0,0 +1,69 @@
+/**
+ * @file crc_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of the table driven CRCs sliced by 1, 4 and 8 bytes against the bitwise reference
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "crc.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+std::vector<uint8_t> RandomBytes(size_t size)
+{
+	std::mt19937 random(1);
+	std::vector<uint8_t> bytes(size);
+	for (uint8_t& byte : bytes)
+		byte = (uint8_t)random();
+
+	return bytes;
+}
+
+template <typename Algorithm>
+void BM_CrcBitwise(benchmark::State& state)
+{
+	std::vector<uint8_t> data = RandomBytes(state.range(0));
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(Algorithm::ComputeBitwise(data.data(), data.size()));
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+template <typename Algorithm>
+void BM_CrcTable(benchmark::State& state)
+{
+	std::vector<uint8_t> data = RandomBytes(state.range(0));
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(Algorithm::Compute(data.data(), data.size()));
+
+	state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// From a CAN frame up to a flash page
+BENCHMARK(BM_CrcBitwise<Crc32<>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc32<1>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc32<4>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc32<8>>)->RangeMultiplier(8)->Range(8, 4096);
+
+BENCHMARK(BM_CrcBitwise<Crc16Ccitt<>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc16Ccitt<1>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc16Ccitt<4>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc16Ccitt<8>>)->RangeMultiplier(8)->Range(8, 4096);
+
+BENCHMARK(BM_CrcBitwise<Crc8<>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc8<1>>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CrcTable<Crc8<8>>)->RangeMultiplier(8)->Range(8, 4096);
+
+} // namespace
@@ -0,0 +1,55 @@
+/**
+ * @file errors_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of building and rendering nested error messages
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "errors.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief Report a formatted error wrapped by a number of callers, then render the whole chain
+void BM_ErrorMessageFormat(benchmark::State& state)
+{
+	char buffer[ErrorMessage::RenderBufferSize];
+
+	for (auto _ : state)
+	{
+		ErrorMessage::SetFormattedMessage("Sensor %d read failed with %d", 3, -5);
+		for (int64_t i = 1; i < state.range(0); i++)
+			ErrorMessage::WrapMessage("Caller failed");
+
+		benchmark::DoNotOptimize(ErrorMessage::WriteMessage(buffer, sizeof(buffer)));
+	}
+
+	ErrorMessage::ClearMessage();
+}
+BENCHMARK(BM_ErrorMessageFormat)->DenseRange(1, ErrorMessage::MaxErrors, 1);
+
+/// @brief Report an error code wrapped by a number of callers, the code is only described when rendered
+void BM_ErrorMessageCode(benchmark::State& state)
+{
+	char buffer[ErrorMessage::RenderBufferSize];
+
+	for (auto _ : state)
+	{
+		ErrorMessage::SetMessage(Errors::SchedulerInvalidConfiguration);
+		for (int64_t i = 1; i < state.range(0); i++)
+			ErrorMessage::WrapMessage(Errors::SchedulerPrecisionTooHigh);
+
+		benchmark::DoNotOptimize(ErrorMessage::WriteMessage(buffer, sizeof(buffer)));
+	}
+
+	ErrorMessage::ClearMessage();
+}
+BENCHMARK(BM_ErrorMessageCode)->DenseRange(1, ErrorMessage::MaxErrors, 1);
+
+} // namespace
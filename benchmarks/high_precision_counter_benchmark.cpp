@@ -0,0 +1,63 @@
+/**
+ * @file high_precision_counter_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of reading the microsecond counter and of its delayed callbacks
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "high_precision_counter.hpp"
+#include "interrupt_queue.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace PSR;
+
+namespace
+{
+
+TIM_TypeDef counterTim;
+HighPrecisionCounter counter(&counterTim, 1000);
+
+void CounterIrqHandler()
+{
+	counter.Update(counterTim.SR);
+}
+
+void SetUpCounter()
+{
+	HOST_TIM_Attach(&counterTim, CounterIrqHandler);
+	counter.Init();
+}
+
+void BM_HighPrecisionCounterGetCount(benchmark::State& state)
+{
+	SetUpCounter();
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(counter.GetCount());
+}
+BENCHMARK(BM_HighPrecisionCounterGetCount);
+
+/// @brief Add a batch of callbacks due over the next microseconds, then advance the timer until all of them have run
+void BM_HighPrecisionCounterCallbacks(benchmark::State& state)
+{
+	SetUpCounter();
+	int calls = 0;
+
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < state.range(0); i++)
+			counter.AddDelayedCallbackMicroseconds(1 + i, [&calls] { calls++; });
+
+		HOST_TIM_Advance(&counterTim, (uint32_t)state.range(0) + 1);
+		InterruptQueue::HandleQueue();
+	}
+
+	benchmark::DoNotOptimize(calls);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HighPrecisionCounterCallbacks)->RangeMultiplier(2)->Range(1, 32);
+
+} // namespace
@@ -0,0 +1,97 @@
+/**
+ * @file inplace_function_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of InplaceFunction against std::function for small and large captures
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "inplace_function.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief Captured state of a given size, the two pointer size fits `std::function`'s local buffer and the larger one does not
+template <size_t Size>
+struct Capture
+{
+	uint32_t Values[Size / sizeof(uint32_t)];
+};
+
+/// @brief Build a callback from a lambda and call it, as when a callback is queued from an interrupt and run
+template <typename Function, size_t Size>
+void BM_ConstructCall(benchmark::State& state)
+{
+	Capture<Size> capture = {};
+	uint32_t sum          = 0;
+
+	for (auto _ : state)
+	{
+		capture.Values[0]++;
+		Function function = [capture, &sum] { sum += capture.Values[0]; };
+		benchmark::DoNotOptimize(function);
+		function();
+	}
+
+	benchmark::DoNotOptimize(sum);
+}
+
+/// @brief Copy an existing callback, as the interrupt queue does into and out of its ring
+template <typename Function, size_t Size>
+void BM_Copy(benchmark::State& state)
+{
+	Capture<Size> capture = {};
+	uint32_t sum          = 0;
+	Function source       = [capture, &sum] { sum += capture.Values[0]; };
+
+	for (auto _ : state)
+	{
+		Function copy = source;
+		benchmark::DoNotOptimize(copy);
+	}
+
+	benchmark::DoNotOptimize(sum);
+}
+
+/// @brief Call an existing callback
+template <typename Function, size_t Size>
+void BM_Call(benchmark::State& state)
+{
+	Capture<Size> capture = {};
+	uint32_t sum          = 0;
+	Function function     = [capture, &sum] { sum += capture.Values[0]; };
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(function);
+		function();
+	}
+
+	benchmark::DoNotOptimize(sum);
+}
+
+// 8 bytes of state plus the reference fit the default capacity, 24 bytes plus the reference need a larger one
+using SmallInplace = InplaceFunction<void()>;
+using LargeInplace = InplaceFunction<void(), 32>;
+
+BENCHMARK(BM_ConstructCall<SmallInplace, 8>);
+BENCHMARK(BM_ConstructCall<std::function<void()>, 8>);
+BENCHMARK(BM_ConstructCall<LargeInplace, 24>);
+BENCHMARK(BM_ConstructCall<std::function<void()>, 24>);
+
+BENCHMARK(BM_Copy<SmallInplace, 8>);
+BENCHMARK(BM_Copy<std::function<void()>, 8>);
+BENCHMARK(BM_Copy<LargeInplace, 24>);
+BENCHMARK(BM_Copy<std::function<void()>, 24>);
+
+BENCHMARK(BM_Call<SmallInplace, 8>);
+BENCHMARK(BM_Call<std::function<void()>, 8>);
+
+} // namespace
@@ -0,0 +1,53 @@
+/**
+ * @file interrupt_queue_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of queueing callbacks from interrupts and draining them
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "interrupt_queue.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace PSR;
+
+namespace
+{
+
+int calls = 0;
+
+/// @brief Queue a batch of callbacks, then run them all from the main loop
+void BM_InterruptQueueEnqueueDrain(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < state.range(0); i++)
+			InterruptQueue::AddInterrupt([] { calls++; });
+
+		InterruptQueue::HandleQueue();
+	}
+
+	benchmark::DoNotOptimize(calls);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InterruptQueueEnqueueDrain)->RangeMultiplier(2)->Range(1, InterruptQueue::GetDepth());
+
+/// @brief Queue a batch of callbacks spread over every priority lane, then run them all
+void BM_InterruptQueuePriorityLanes(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < state.range(0); i++)
+			InterruptQueue::AddInterrupt([] { calls++; }, (InterruptPriority)(i % InterruptQueue::PriorityCount));
+
+		InterruptQueue::HandleQueue();
+	}
+
+	benchmark::DoNotOptimize(calls);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InterruptQueuePriorityLanes)->RangeMultiplier(2)->Range(4, InterruptQueue::GetDepth());
+
+} // namespace
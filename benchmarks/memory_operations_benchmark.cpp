@@ -0,0 +1,170 @@
+/**
+ * @file memory_operations_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of the endian aware reads and writes against a memcpy baseline
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "memory_operations.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief The number of fields in a packet, each at an odd offset so none of them is aligned
+constexpr size_t FieldCount = 64;
+constexpr size_t PacketSize = 1 + FieldCount * sizeof(uint32_t);
+
+std::vector<uint8_t> Packet()
+{
+	std::vector<uint8_t> packet(PacketSize);
+	for (size_t i = 0; i < packet.size(); i++)
+		packet[i] = (uint8_t)(i * 37);
+
+	return packet;
+}
+
+/// @brief The baseline, an unaligned load in the processor's byte order
+void BM_ReadMemcpy(benchmark::State& state)
+{
+	std::vector<uint8_t> packet = Packet();
+
+	for (auto _ : state)
+	{
+		uint32_t sum = 0;
+		for (size_t i = 0; i < FieldCount; i++)
+		{
+			uint32_t value;
+			memcpy(&value, &packet[1 + i * sizeof(uint32_t)], sizeof(value));
+			sum += value;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * FieldCount * sizeof(uint32_t));
+}
+BENCHMARK(BM_ReadMemcpy);
+
+void BM_ReadLittleEndian(benchmark::State& state)
+{
+	std::vector<uint8_t> packet = Packet();
+
+	for (auto _ : state)
+	{
+		uint32_t sum = 0;
+		for (size_t i = 0; i < FieldCount; i++)
+			sum += readLittleEndian<uint32_t>(packet.data(), 1 + i * sizeof(uint32_t));
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * FieldCount * sizeof(uint32_t));
+}
+BENCHMARK(BM_ReadLittleEndian);
+
+void BM_ReadBigEndian(benchmark::State& state)
+{
+	std::vector<uint8_t> packet = Packet();
+
+	for (auto _ : state)
+	{
+		uint32_t sum = 0;
+		for (size_t i = 0; i < FieldCount; i++)
+			sum += readBigEndian<uint32_t>(packet.data(), 1 + i * sizeof(uint32_t));
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.iterations() * FieldCount * sizeof(uint32_t));
+}
+BENCHMARK(BM_ReadBigEndian);
+
+/// @brief The baseline, an unaligned store in the processor's byte order
+void BM_WriteMemcpy(benchmark::State& state)
+{
+	std::vector<uint8_t> packet(PacketSize);
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FieldCount; i++)
+		{
+			uint32_t value = (uint32_t)i;
+			memcpy(&packet[1 + i * sizeof(uint32_t)], &value, sizeof(value));
+		}
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * FieldCount * sizeof(uint32_t));
+}
+BENCHMARK(BM_WriteMemcpy);
+
+void BM_WriteBigEndian(benchmark::State& state)
+{
+	std::vector<uint8_t> packet(PacketSize);
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < FieldCount; i++)
+			writeBigEndian<uint32_t>((uint32_t)i, packet.data(), 1 + i * sizeof(uint32_t));
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * FieldCount * sizeof(uint32_t));
+}
+BENCHMARK(BM_WriteBigEndian);
+
+/// @brief The baseline for whole arrays, one block copy without conversion
+void BM_ReadArrayMemcpy(benchmark::State& state)
+{
+	std::vector<uint8_t> packet = Packet();
+	uint32_t values[FieldCount];
+
+	for (auto _ : state)
+	{
+		memcpy(values, packet.data() + 1, sizeof(values));
+		benchmark::DoNotOptimize(values);
+	}
+
+	state.SetBytesProcessed(state.iterations() * sizeof(values));
+}
+BENCHMARK(BM_ReadArrayMemcpy);
+
+void BM_ReadArrayBigEndian(benchmark::State& state)
+{
+	std::vector<uint8_t> packet = Packet();
+	uint32_t values[FieldCount];
+
+	for (auto _ : state)
+	{
+		readArrayBigEndian(packet.data(), values, FieldCount, 1);
+		benchmark::DoNotOptimize(values);
+	}
+
+	state.SetBytesProcessed(state.iterations() * sizeof(values));
+}
+BENCHMARK(BM_ReadArrayBigEndian);
+
+void BM_WriteArrayBigEndian(benchmark::State& state)
+{
+	std::vector<uint8_t> packet(PacketSize);
+	uint32_t values[FieldCount];
+	for (size_t i = 0; i < FieldCount; i++)
+		values[i] = (uint32_t)i;
+
+	for (auto _ : state)
+	{
+		writeArrayBigEndian(values, FieldCount, packet.data(), 1);
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * sizeof(values));
+}
+BENCHMARK(BM_WriteArrayBigEndian);
+
+} // namespace
@@ -0,0 +1,158 @@
+/**
+ * @file scheduler_benchmark.cpp
+ * @author Purdue Solar Racing
+ * @brief Host benchmarks of the scheduler timer interrupt against the linear scan over every task it replaced
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "interrupt_queue.hpp"
+#include "scheduler.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <bitset>
+#include <limits>
+
+using namespace PSR;
+
+namespace
+{
+
+TIM_TypeDef schedulerTim;
+
+/**
+ * @brief The timer interrupt the timing wheel replaced, which visits every task up to the highest one added on every tick
+ * @remark The task storage and the late window are the same as `Scheduler`'s, so only the search differs
+ */
+class LinearScanScheduler
+{
+  private:
+	static constexpr size_t MaxTasks    = 32;
+	static constexpr uint32_t Precision = 32;
+	static constexpr uint32_t RollOver  = std::numeric_limits<uint32_t>::max() / 2;
+
+	std::array<InplaceFunction<void()>, MaxTasks> tasks = { nullptr };
+	std::array<uint32_t, MaxTasks> intervals            = { 0 };
+	std::array<uint32_t, MaxTasks> nextUpdates          = { 0 };
+	std::bitset<MaxTasks> enabledTasks;
+	size_t highestTaskIndex = 0;
+	uint32_t counter        = 0;
+
+  public:
+	void AddTask(const InplaceFunction<void()>& task, uint32_t interval)
+	{
+		tasks[highestTaskIndex]        = task;
+		intervals[highestTaskIndex]    = interval;
+		nextUpdates[highestTaskIndex]  = counter + interval;
+		enabledTasks[highestTaskIndex] = true;
+		highestTaskIndex++;
+	}
+
+	void Update()
+	{
+		if (++counter >= RollOver)
+			counter = 0;
+
+		for (size_t i = 0; i < highestTaskIndex; i++)
+		{
+			InplaceFunction<void()>& task = tasks[i];
+			if (task == nullptr || !enabledTasks[i])
+				continue;
+
+			int32_t diff = counter - nextUpdates[i];
+			if (diff >= 0 && diff < (int32_t)(Precision / 2))
+			{
+				// If the interrupt queue is full, try again next time
+				if (!InterruptQueue::AddInterrupt(task))
+					continue;
+
+				uint32_t nextUpdate = counter + intervals[i];
+				nextUpdates[i]      = nextUpdate >= RollOver ? nextUpdate - RollOver : nextUpdate;
+			}
+		}
+	}
+};
+
+/// @brief A tick where no task is due, the linear scan still visits every task
+void BM_LinearScanUpdateIdle(benchmark::State& state)
+{
+	LinearScanScheduler scheduler;
+	for (int64_t i = 0; i < state.range(0); i++)
+		scheduler.AddTask([] {}, (uint32_t)(10000 + i));
+
+	for (auto _ : state)
+		scheduler.Update();
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LinearScanUpdateIdle)->RangeMultiplier(2)->Range(1, 32);
+
+/// @brief A tick where every task is due and is queued, then drained by the main loop
+void BM_LinearScanUpdateDeferred(benchmark::State& state)
+{
+	LinearScanScheduler scheduler;
+	for (int64_t i = 0; i < state.range(0); i++)
+		scheduler.AddTask([] {}, 1u);
+
+	for (auto _ : state)
+	{
+		scheduler.Update();
+		InterruptQueue::HandleQueue();
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LinearScanUpdateDeferred)->RangeMultiplier(2)->Range(1, 32);
+
+/// @brief A tick where no task is due, only the tasks sharing the wheel slot of the tick are visited
+void BM_SchedulerUpdateIdle(benchmark::State& state)
+{
+	Scheduler scheduler(&schedulerTim, 1000);
+	scheduler.Init();
+	for (int64_t i = 0; i < state.range(0); i++)
+		scheduler.AddTask([] {}, (uint32_t)(10000 + i));
+
+	for (auto _ : state)
+		scheduler.Update();
+
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SchedulerUpdateIdle)->RangeMultiplier(2)->Range(1, 32);
+
+/// @brief A tick where every task is due and is queued, then drained by the main loop
+void BM_SchedulerUpdateDeferred(benchmark::State& state)
+{
+	Scheduler scheduler(&schedulerTim, 1000);
+	scheduler.Init();
+	for (int64_t i = 0; i < state.range(0); i++)
+		scheduler.AddTask([] {}, 1u);
+
+	for (auto _ : state)
+	{
+		scheduler.Update();
+		InterruptQueue::HandleQueue();
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SchedulerUpdateDeferred)->RangeMultiplier(2)->Range(1, 32);
+
+/// @brief A tick where every task is due and runs in the timer interrupt against its budget
+void BM_SchedulerUpdateInterruptTasks(benchmark::State& state)
+{
+	Scheduler scheduler(&schedulerTim, 1000);
+	scheduler.Init();
+	for (int64_t i = 0; i < state.range(0); i++)
+		scheduler.AddInterruptTask([] {}, 1u, 1000u);
+
+	for (auto _ : state)
+		scheduler.Update();
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SchedulerUpdateInterruptTasks)->RangeMultiplier(2)->Range(1, 32);
+
+} // namespace
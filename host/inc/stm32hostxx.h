@@ -0,0 +1,236 @@
+/**
+ * @file stm32hostxx.h
+ * @author Purdue Solar Racing
+ * @brief Register level stand-in for an STM32 device header, used to build and simulate the library on a host
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_H
+#define __STM32HOSTXX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Defined when the library is built against the simulated host HAL
+#define STM32_HOST_SIMULATION 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct HostRegister;
+
+/// @brief Read the value of a simulated register, applying its side effects
+uint32_t HOST_RegisterRead(const volatile struct HostRegister* reg);
+/// @brief Write the value of a simulated register, applying its side effects
+void HOST_RegisterWrite(volatile struct HostRegister* reg, uint32_t value);
+
+/**
+ * @brief Set a function that is called before every simulated register read
+ * @remark Lets a test advance timers or raise interrupts at the most adversarial moment, between two reads of related registers.
+ * Register reads made by the hook itself do not call it again
+ *
+ * @param hook The function to call with the address of the register being read, or `NULL` to remove the hook
+ */
+void HOST_SetRegisterReadHook(void (*hook)(const volatile void* reg));
+
+#ifdef __cplusplus
+}
+
+/**
+ * @brief A 32-bit peripheral register whose reads and writes go through the simulation
+ * @remark Has the same layout as `volatile uint32_t`, so C translation units can share the peripheral structures
+ */
+struct HostRegister
+{
+	volatile uint32_t Value;
+
+	operator uint32_t() const volatile { return HOST_RegisterRead(this); }
+
+	// Assignments return nothing so that a discarded result does not imply another volatile read
+	void operator=(uint32_t value) volatile { HOST_RegisterWrite(this, value); }
+	void operator|=(uint32_t value) volatile { HOST_RegisterWrite(this, *this | value); }
+	void operator&=(uint32_t value) volatile { HOST_RegisterWrite(this, *this & value); }
+	void operator^=(uint32_t value) volatile { HOST_RegisterWrite(this, *this ^ value); }
+};
+
+#define __HOST_REG HostRegister
+#else
+#define __HOST_REG volatile uint32_t
+#endif
+
+/// @brief Timer peripheral registers, in the same order as the CMSIS device headers
+typedef struct
+{
+	__HOST_REG CR1;
+	__HOST_REG CR2;
+	__HOST_REG SMCR;
+	__HOST_REG DIER;
+	__HOST_REG SR;
+	__HOST_REG EGR;
+	__HOST_REG CCMR1;
+	__HOST_REG CCMR2;
+	__HOST_REG CCER;
+	__HOST_REG CNT;
+	__HOST_REG PSC;
+	__HOST_REG ARR;
+	__HOST_REG RCR;
+	__HOST_REG CCR1;
+	__HOST_REG CCR2;
+	__HOST_REG CCR3;
+	__HOST_REG CCR4;
+	__HOST_REG BDTR;
+	__HOST_REG DCR;
+	__HOST_REG DMAR;
+	__HOST_REG OR;
+} TIM_TypeDef;
+
+/// @brief GPIO port registers, in the same order as the CMSIS device headers
+typedef struct
+{
+	__HOST_REG MODER;
+	__HOST_REG OTYPER;
+	__HOST_REG OSPEEDR;
+	__HOST_REG PUPDR;
+	__HOST_REG IDR;
+	__HOST_REG ODR;
+	__HOST_REG BSRR;
+	__HOST_REG LCKR;
+	__HOST_REG AFR[2];
+} GPIO_TypeDef;
+
+/// @brief USART registers, in the same order as the CMSIS device headers
+typedef struct
+{
+	__HOST_REG SR;
+	__HOST_REG DR;
+	__HOST_REG BRR;
+	__HOST_REG CR1;
+	__HOST_REG CR2;
+	__HOST_REG CR3;
+	__HOST_REG GTPR;
+} USART_TypeDef;
+
+extern GPIO_TypeDef HOST_GPIOA;
+extern GPIO_TypeDef HOST_GPIOB;
+extern GPIO_TypeDef HOST_GPIOC;
+extern GPIO_TypeDef HOST_GPIOD;
+#define GPIOA (&HOST_GPIOA)
+#define GPIOB (&HOST_GPIOB)
+#define GPIOC (&HOST_GPIOC)
+#define GPIOD (&HOST_GPIOD)
+
+extern USART_TypeDef HOST_USART1;
+extern USART_TypeDef HOST_USART2;
+extern USART_TypeDef HOST_USART3;
+#define USART1 (&HOST_USART1)
+#define USART2 (&HOST_USART2)
+#define USART3 (&HOST_USART3)
+
+/// @brief System control block, only the registers the library uses
+typedef struct
+{
+	volatile uint32_t CPUID;
+	volatile uint32_t ICSR;
+} SCB_Type;
+
+extern SCB_Type HOST_SCB;
+#define SCB (&HOST_SCB)
+
+#define SCB_ICSR_VECTACTIVE_Pos 0U
+#define SCB_ICSR_VECTACTIVE_Msk (0x1FFU << SCB_ICSR_VECTACTIVE_Pos)
+
+/// @brief Data watchpoint and trace unit, only the cycle counter
+typedef struct
+{
+	__HOST_REG CTRL;
+	__HOST_REG CYCCNT;
+} DWT_Type;
+
+/// @brief Core debug registers, only the trace enable
+typedef struct
+{
+	__HOST_REG DHCSR;
+	__HOST_REG DCRSR;
+	__HOST_REG DCRDR;
+	__HOST_REG DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type HOST_DWT;
+extern CoreDebug_Type HOST_CoreDebug;
+#define DWT       (&HOST_DWT)
+#define CoreDebug (&HOST_CoreDebug)
+
+#define DWT_CTRL_CYCCNTENA_Pos 0U
+#define DWT_CTRL_CYCCNTENA_Msk (0x1U << DWT_CTRL_CYCCNTENA_Pos)
+
+#define CoreDebug_DEMCR_TRCENA_Pos 24U
+#define CoreDebug_DEMCR_TRCENA_Msk (0x1U << CoreDebug_DEMCR_TRCENA_Pos)
+
+// Every simulated peripheral is treated as an APB1 peripheral by GetTimerInputFrequency. Not zero, which would make its
+// address comparison always true and warn
+#define APB1PERIPH_BASE 1UL
+
+#define TIM_CR1_CEN  (0x1U << 0U)
+#define TIM_CR1_UDIS (0x1U << 1U)
+#define TIM_CR1_URS  (0x1U << 2U)
+#define TIM_CR1_OPM  (0x1U << 3U)
+#define TIM_CR1_DIR  (0x1U << 4U)
+#define TIM_CR1_ARPE (0x1U << 7U)
+
+#define TIM_CR2_MMS_Pos 4U
+#define TIM_CR2_MMS     (0x7U << TIM_CR2_MMS_Pos)
+
+#define TIM_SMCR_SMS_Pos 0U
+#define TIM_SMCR_SMS     (0x7U << TIM_SMCR_SMS_Pos)
+#define TIM_SMCR_TS_Pos  4U
+#define TIM_SMCR_TS      (0x7U << TIM_SMCR_TS_Pos)
+
+#define TIM_DIER_UIE   (0x1U << 0U)
+#define TIM_DIER_CC1IE (0x1U << 1U)
+#define TIM_DIER_CC2IE (0x1U << 2U)
+#define TIM_DIER_CC3IE (0x1U << 3U)
+#define TIM_DIER_CC4IE (0x1U << 4U)
+
+#define TIM_SR_UIF   (0x1U << 0U)
+#define TIM_SR_CC1IF (0x1U << 1U)
+#define TIM_SR_CC2IF (0x1U << 2U)
+#define TIM_SR_CC3IF (0x1U << 3U)
+#define TIM_SR_CC4IF (0x1U << 4U)
+
+#define TIM_EGR_UG   (0x1U << 0U)
+#define TIM_EGR_CC1G (0x1U << 1U)
+#define TIM_EGR_CC2G (0x1U << 2U)
+#define TIM_EGR_CC3G (0x1U << 3U)
+#define TIM_EGR_CC4G (0x1U << 4U)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+uint32_t HOST_GetPrimask(void);
+void HOST_SetPrimask(uint32_t primask);
+
+/**
+ * @brief Advance the virtual clock by a microsecond
+ * @remark Spin waits call `__NOP` while polling a flag that a peripheral sets, in the simulation the peripheral only
+ * makes progress when the virtual clock moves
+ */
+void HOST_Nop(void);
+
+static inline uint32_t __get_PRIMASK(void) { return HOST_GetPrimask(); }
+static inline void __set_PRIMASK(uint32_t primask) { HOST_SetPrimask(primask); }
+static inline void __disable_irq(void) { HOST_SetPrimask(1); }
+static inline void __enable_irq(void) { HOST_SetPrimask(0); }
+static inline void __NOP(void) { HOST_Nop(); }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx.h
@@ -0,0 +1,68 @@
+/**
+ * @file stm32hostxx_hal.h
+ * @author Purdue Solar Racing
+ * @brief Simulated HAL used to build the library on a host
+ * @remark Build with `STM32_PROCESSOR=host` and `host/inc` on the include path, and compile `host/src`
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_H
+#define __STM32HOSTXX_HAL_H
+
+#include "stm32hostxx.h"
+#include "stm32hostxx_hal_def.h"
+#include "stm32hostxx_hal_dma.h"
+#include "stm32hostxx_hal_gpio.h"
+#include "stm32hostxx_hal_rcc.h"
+#include "stm32hostxx_hal_tim.h"
+#include "stm32hostxx_hal_uart.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Get the virtual time in milliseconds
+ */
+uint32_t HAL_GetTick(void);
+
+/**
+ * @brief Wait for a number of milliseconds, advancing the virtual clock
+ */
+void HAL_Delay(uint32_t delay);
+
+/**
+ * @brief Get the virtual time
+ *
+ * @return `uint64_t` The number of core clock cycles since the simulation started
+ */
+uint64_t HOST_GetTime(void);
+
+/**
+ * @brief Advance the virtual clock
+ * @remark Every attached timer that is enabled and not clocked by another timer advances by the number of ticks its
+ * input clock and prescaler give for the elapsed time, raising its interrupts. Timers advance one after another,
+ * so advance in small steps when the order of interrupts between timers matters
+ *
+ * @param cycles The number of core clock cycles to advance by
+ */
+void HOST_AdvanceTime(uint64_t cycles);
+
+/**
+ * @brief Select the time base of the DWT cycle counter
+ * @remark By default the cycle counter follows the host's steady clock scaled to the core clock, so code can be profiled.
+ * With the virtual clock it only moves with `HOST_AdvanceTime`, so simulations are deterministic
+ *
+ * @param useVirtualClock Nonzero to follow the virtual clock
+ */
+void HOST_SetCycleCounterSource(int useVirtualClock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx_hal.h
@@ -0,0 +1,26 @@
+/**
+ * @file stm32hostxx_hal_def.h
+ * @author Purdue Solar Racing
+ * @brief Common HAL definitions for the simulated host HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_DEF_H
+#define __STM32HOSTXX_HAL_DEF_H
+
+#include "stm32hostxx.h"
+
+typedef enum
+{
+	HAL_OK      = 0x00U,
+	HAL_ERROR   = 0x01U,
+	HAL_BUSY    = 0x02U,
+	HAL_TIMEOUT = 0x03U,
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+#endif // End of include guard for stm32hostxx_hal_def.h
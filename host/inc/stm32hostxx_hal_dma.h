@@ -0,0 +1,29 @@
+/**
+ * @file stm32hostxx_hal_dma.h
+ * @author Purdue Solar Racing
+ * @brief DMA definitions for the simulated host HAL, transfers are simulated by the peripherals that use them
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_DMA_H
+#define __STM32HOSTXX_HAL_DMA_H
+
+#include "stm32hostxx_hal_def.h"
+
+#define DMA_NORMAL   0x00000000U
+#define DMA_CIRCULAR 0x00000100U
+
+typedef struct
+{
+	uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+	DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+#endif // End of include guard for stm32hostxx_hal_dma.h
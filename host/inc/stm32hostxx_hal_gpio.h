@@ -0,0 +1,67 @@
+/**
+ * @file stm32hostxx_hal_gpio.h
+ * @author Purdue Solar Racing
+ * @brief GPIO definitions and pin simulation for the simulated host HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_GPIO_H
+#define __STM32HOSTXX_HAL_GPIO_H
+
+#include "stm32hostxx_hal_def.h"
+
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+#define GPIO_PIN_All ((uint16_t)0xFFFF)
+
+// Values of each two bit field of MODER
+#define GPIO_MODE_INPUT  0x0U
+#define GPIO_MODE_OUTPUT 0x1U
+
+typedef enum
+{
+	GPIO_PIN_RESET = 0,
+	GPIO_PIN_SET,
+} GPIO_PinState;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin);
+
+/**
+ * @brief Drive the level of input pins from outside the chip
+ * @remark `IDR` follows `ODR` for pins whose `MODER` field is output, and the level set here for every other pin
+ *
+ * @param port The GPIO port
+ * @param pins The pin bitmask
+ * @param state The level to drive the pins to
+ */
+void HOST_GPIO_SetInput(GPIO_TypeDef* port, uint16_t pins, GPIO_PinState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx_hal_gpio.h
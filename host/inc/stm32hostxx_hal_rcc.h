@@ -0,0 +1,55 @@
+/**
+ * @file stm32hostxx_hal_rcc.h
+ * @author Purdue Solar Racing
+ * @brief Clock configuration queries for the simulated host HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_RCC_H
+#define __STM32HOSTXX_HAL_RCC_H
+
+#include "stm32hostxx_hal_def.h"
+
+#define RCC_HCLK_DIV1  0x00000000U
+#define RCC_HCLK_DIV2  0x00001000U
+#define RCC_HCLK_DIV4  0x00001400U
+#define RCC_HCLK_DIV8  0x00001800U
+#define RCC_HCLK_DIV16 0x00001C00U
+
+typedef struct
+{
+	uint32_t ClockType;
+	uint32_t SYSCLKSource;
+	uint32_t AHBCLKDivider;
+	uint32_t APB1CLKDivider;
+	uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef* clkConfig, uint32_t* flashLatency);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+/**
+ * @brief Set the simulated clock tree
+ *
+ * @param sysClock The system and AHB clock frequency in Hertz
+ * @param apb1Divider The APB1 prescaler, one of `RCC_HCLK_DIVx`
+ * @param apb2Divider The APB2 prescaler, one of `RCC_HCLK_DIVx`
+ */
+void HOST_RCC_SetClocks(uint32_t sysClock, uint32_t apb1Divider, uint32_t apb2Divider);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx_hal_rcc.h
@@ -0,0 +1,73 @@
+/**
+ * @file stm32hostxx_hal_tim.h
+ * @author Purdue Solar Racing
+ * @brief Timer definitions and timer simulation for the simulated host HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_TIM_H
+#define __STM32HOSTXX_HAL_TIM_H
+
+#include "stm32hostxx_hal_def.h"
+
+#define TIM_CHANNEL_1 0x00000000U
+#define TIM_CHANNEL_2 0x00000004U
+#define TIM_CHANNEL_3 0x00000008U
+#define TIM_CHANNEL_4 0x0000000CU
+
+#define TIM_TRGO_UPDATE (0x2U << TIM_CR2_MMS_Pos)
+
+#define TIM_SLAVEMODE_EXTERNAL1 (0x7U << TIM_SMCR_SMS_Pos)
+
+// On the host, ITRx is the TRGO of the x-th timer passed to HOST_TIM_Attach
+#define TIM_TS_ITR0 (0x0U << TIM_SMCR_TS_Pos)
+#define TIM_TS_ITR1 (0x1U << TIM_SMCR_TS_Pos)
+#define TIM_TS_ITR2 (0x2U << TIM_SMCR_TS_Pos)
+#define TIM_TS_ITR3 (0x3U << TIM_SMCR_TS_Pos)
+
+typedef struct
+{
+	TIM_TypeDef* Instance;
+} TIM_HandleTypeDef;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Register a timer with the simulation
+ * @remark Registered timers get hardware semantics: `SR` is clear-on-write-zero and `EGR` generates events
+ *
+ * @param tim The timer to simulate
+ * @param irqHandler Called like an interrupt when an enabled flag is raised, may be `NULL`
+ */
+void HOST_TIM_Attach(TIM_TypeDef* tim, void (*irqHandler)(void));
+
+/**
+ * @brief Remove a timer from the simulation
+ *
+ * @param tim The timer to remove
+ */
+void HOST_TIM_Detach(TIM_TypeDef* tim);
+
+/**
+ * @brief Advance a simulated timer, raising flags and interrupts as the hardware would
+ * @remark The counter counts up, rolling over after `ARR`, and only while `CR1_CEN` is set.
+ * Like the hardware's shadow registers, a new `PSC` is only used after an update event, from an overflow or `EGR_UG`,
+ * and so is a new `ARR` when `CR1_ARPE` is set.
+ * A timer whose TRGO is its update event clocks any slave in external clock mode 1 that selects it as its trigger
+ *
+ * @param tim The timer to advance
+ * @param ticks The number of counter ticks, after the prescaler
+ */
+void HOST_TIM_Advance(TIM_TypeDef* tim, uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx_hal_tim.h
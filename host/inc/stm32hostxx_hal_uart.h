@@ -0,0 +1,140 @@
+/**
+ * @file stm32hostxx_hal_uart.h
+ * @author Purdue Solar Racing
+ * @brief UART definitions and serial line simulation for the simulated host HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_HAL_UART_H
+#define __STM32HOSTXX_HAL_UART_H
+
+#include "stm32hostxx_hal_def.h"
+#include "stm32hostxx_hal_dma.h"
+
+typedef enum
+{
+	HAL_UART_STATE_RESET   = 0x00U,
+	HAL_UART_STATE_READY   = 0x20U,
+	HAL_UART_STATE_BUSY    = 0x24U,
+	HAL_UART_STATE_BUSY_TX = 0x21U,
+	HAL_UART_STATE_BUSY_RX = 0x22U,
+} HAL_UART_StateTypeDef;
+
+#define HAL_UART_RECEPTION_STANDARD 0x00000000U
+#define HAL_UART_RECEPTION_TOIDLE   0x00000001U
+
+typedef struct
+{
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+	uint32_t Mode;
+	uint32_t HwFlowCtl;
+	uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct __UART_HandleTypeDef
+{
+	USART_TypeDef* Instance;
+	UART_InitTypeDef Init;
+	const uint8_t* pTxBuffPtr;
+	uint16_t TxXferSize;
+	volatile uint16_t TxXferCount;
+	uint8_t* pRxBuffPtr;
+	uint16_t RxXferSize;
+	volatile uint16_t RxXferCount;
+	volatile uint32_t ReceptionType;
+	DMA_HandleTypeDef* hdmarx;
+	volatile HAL_UART_StateTypeDef gState;
+	volatile HAL_UART_StateTypeDef RxState;
+	volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Send bytes on the simulated line
+ * @remark The virtual clock advances by the time the bytes take at `Init.BaudRate`, with 10 bits per byte
+ */
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout);
+
+/**
+ * @brief Start sending bytes on the simulated line without waiting
+ * @remark The bytes go out one at a time as the virtual clock advances, at `Init.BaudRate` with 10 bits per byte,
+ * and `HAL_UART_TxCpltCallback` is called from simulated interrupt context once the last one is sent.
+ * The buffer must stay valid until then
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size);
+
+/**
+ * @brief Start sending bytes on the simulated line with DMA, behaves the same as `HAL_UART_Transmit_IT`
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size);
+
+/**
+ * @brief Called when an interrupt or DMA transmit finishes, a weak default does nothing
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+
+/**
+ * @brief Receive bytes injected with `HOST_UART_Inject`
+ * @remark Returns `HAL_TIMEOUT` after taking the bytes that are available if there are fewer than `size`,
+ * advancing the virtual clock by `timeout` milliseconds unless it is `HAL_MAX_DELAY`
+ */
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size, uint32_t timeout);
+
+/**
+ * @brief Start receiving into a buffer with DMA until the buffer is full or the line goes idle
+ * @remark Bytes injected with `HOST_UART_Inject` arrive one at a time as the virtual clock advances, at `Init.BaudRate`
+ * with 10 bits per byte. `HAL_UARTEx_RxEventCallback` is called from simulated interrupt context with the number of bytes in the buffer
+ * when it is half full, when it is full and when the line has been idle for a byte time after data.
+ * If `hdmarx` is set up in `DMA_CIRCULAR` mode, reception wraps around and continues, otherwise it stops after the event.
+ * Events raised while interrupts are masked are merged into the latest one
+ */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size);
+
+/**
+ * @brief Stop a DMA or interrupt reception
+ */
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart);
+
+/**
+ * @brief Called on receive to idle events, a weak default does nothing
+ *
+ * @param huart The UART handle
+ * @param size The number of bytes in the buffer, counted from its start
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t size);
+
+/**
+ * @brief Make bytes arrive on the receive line of a simulated UART
+ *
+ * @param huart The UART handle
+ * @param data The bytes to receive
+ * @param size The number of bytes
+ * @return `size_t` The number of bytes accepted, less than `size` if the simulated line buffer is full
+ */
+size_t HOST_UART_Inject(UART_HandleTypeDef* huart, const uint8_t* data, size_t size);
+
+/**
+ * @brief Take the bytes a simulated UART has sent so far
+ *
+ * @param huart The UART handle
+ * @param data The buffer to copy the bytes into
+ * @param size The size of the buffer
+ * @return `size_t` The number of bytes copied
+ */
+size_t HOST_UART_TakeTransmitted(UART_HandleTypeDef* huart, uint8_t* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // End of include guard for stm32hostxx_hal_uart.h
@@ -0,0 +1,554 @@
+/**
+ * @file stm32hostxx_hal.cpp
+ * @author Purdue Solar Racing
+ * @brief Simulation behind the host HAL: registers, interrupt masking, clocks, the virtual clock, timers and GPIO
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "stm32hostxx_hal.h"
+#include "stm32hostxx_internal.h"
+
+#include <chrono>
+#include <cstddef>
+
+SCB_Type HOST_SCB             = {};
+DWT_Type HOST_DWT             = {};
+CoreDebug_Type HOST_CoreDebug = {};
+GPIO_TypeDef HOST_GPIOA       = {};
+GPIO_TypeDef HOST_GPIOB       = {};
+GPIO_TypeDef HOST_GPIOC       = {};
+GPIO_TypeDef HOST_GPIOD       = {};
+
+namespace
+{
+
+struct SimulatedTimer
+{
+	TIM_TypeDef* Tim;
+	void (*IrqHandler)(void);
+	/// @brief An interrupt was raised while masked or while the handler was running
+	bool Pending;
+	/// @brief The handler is currently running
+	bool Active;
+	/// @brief Timer input clock cycles that have not yet made up a whole prescaled tick
+	uint64_t PrescalerCycles;
+	/// @brief The fraction of a timer input clock cycle left over from the last advance, in units of 1 / sysClock
+	uint64_t InputRemainder;
+	/// @brief The prescaler in use, loaded from `PSC` by an update event like the hardware's shadow register
+	uint32_t Prescaler;
+	/// @brief The auto-reload value in use, loaded from `ARR` by an update event when `ARPE` is set and on every write otherwise
+	uint32_t AutoReload;
+};
+
+constexpr size_t MaxTimers      = 16;
+constexpr uint32_t TimerIrqMask = TIM_SR_UIF | TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF;
+/// @brief The first external interrupt number on Cortex-M, reported through `SCB->ICSR` while a handler runs
+constexpr uint32_t FirstExternalIrq = 16;
+
+SimulatedTimer timers[MaxTimers];
+uint32_t primask = 0;
+
+GPIO_TypeDef* const gpioPorts[] = { &HOST_GPIOA, &HOST_GPIOB, &HOST_GPIOC, &HOST_GPIOD };
+/// @brief The levels driven onto the pins of each port from outside the chip
+uint32_t gpioInputs[sizeof(gpioPorts) / sizeof(gpioPorts[0])];
+
+/// @brief The virtual time in core clock cycles
+uint64_t virtualCycles = 0;
+/// @brief The virtual time in milliseconds, and the fraction of a millisecond in units of 1 / sysClock
+uint32_t tickMilliseconds = 0;
+uint64_t tickRemainder    = 0;
+
+/// @brief Advance the virtual clock in steps of at most this many cycles, which also bounds the interleaving error between timers
+constexpr uint64_t MaxTimeStep = 1 << 20;
+
+void (*readHook)(const volatile void* reg) = nullptr;
+
+uint32_t sysClock    = 16000000;
+uint32_t apb1Divider = RCC_HCLK_DIV1;
+uint32_t apb2Divider = RCC_HCLK_DIV1;
+
+/// @brief The host and virtual time at which the cycle counter last held `HOST_DWT.CYCCNT.Value`
+std::chrono::steady_clock::time_point cycleEpoch;
+uint64_t cycleEpochVirtual = 0;
+bool cycleCounterVirtual   = false;
+
+SimulatedTimer* FindTimer(const volatile void* reg, size_t* offset)
+{
+	uintptr_t address = (uintptr_t)reg;
+	for (SimulatedTimer& timer : timers)
+	{
+		uintptr_t base = (uintptr_t)timer.Tim;
+		if (timer.Tim != nullptr && address >= base && address < base + sizeof(TIM_TypeDef))
+		{
+			*offset = address - base;
+			return &timer;
+		}
+	}
+
+	return nullptr;
+}
+
+void RaiseInterrupt(SimulatedTimer& timer)
+{
+	if (timer.IrqHandler == nullptr)
+		return;
+
+	if (primask != 0 || timer.Active)
+	{
+		timer.Pending = true;
+		return;
+	}
+
+	do
+	{
+		timer.Pending = false;
+		if ((timer.Tim->SR.Value & timer.Tim->DIER.Value & TimerIrqMask) == 0)
+			return;
+
+		uint32_t icsr = HOST_SCB.ICSR;
+		HOST_SCB.ICSR = (icsr & ~SCB_ICSR_VECTACTIVE_Msk) | (FirstExternalIrq + (uint32_t)(&timer - timers));
+		timer.Active  = true;
+
+		timer.IrqHandler();
+
+		timer.Active  = false;
+		HOST_SCB.ICSR = icsr;
+	} while (timer.Pending && primask == 0);
+}
+
+/// @brief An update event moves the preloaded prescaler and auto-reload values into use
+void LoadShadowRegisters(SimulatedTimer& timer)
+{
+	timer.Prescaler  = timer.Tim->PSC.Value & 0xFFFFU;
+	timer.AutoReload = timer.Tim->ARR.Value;
+}
+
+/// @brief Clock any slave timers chained to the update event of a timer through its TRGO
+void ClockSlaves(SimulatedTimer& timer)
+{
+	TIM_TypeDef* tim = timer.Tim;
+	if ((tim->CR2.Value & TIM_CR2_MMS) != TIM_TRGO_UPDATE)
+		return;
+
+	uint32_t trigger = (uint32_t)(&timer - timers) << TIM_SMCR_TS_Pos;
+	for (SimulatedTimer& slave : timers)
+	{
+		if (slave.Tim == nullptr || slave.Tim == tim)
+			continue;
+
+		uint32_t smcr = slave.Tim->SMCR.Value;
+		if ((smcr & TIM_SMCR_SMS) == TIM_SLAVEMODE_EXTERNAL1 && (smcr & TIM_SMCR_TS) == trigger)
+			HOST_TIM_Advance(slave.Tim, 1);
+	}
+}
+
+void GenerateEvents(SimulatedTimer& timer, uint32_t events)
+{
+	TIM_TypeDef* tim = timer.Tim;
+
+	if ((events & TIM_EGR_UG) != 0)
+	{
+		tim->CNT.Value = 0;
+		LoadShadowRegisters(timer);
+		if ((tim->CR1.Value & TIM_CR1_URS) == 0)
+			tim->SR.Value = tim->SR.Value | TIM_SR_UIF;
+
+		// The update event is also the TRGO of a master in update mode
+		ClockSlaves(timer);
+	}
+
+	// CCxG bits line up with the CCxIF flags
+	tim->SR.Value = tim->SR.Value | (events & (TIM_EGR_CC1G | TIM_EGR_CC2G | TIM_EGR_CC3G | TIM_EGR_CC4G));
+
+	RaiseInterrupt(timer);
+}
+
+bool CycleCounterRunning()
+{
+	return (HOST_CoreDebug.DEMCR.Value & CoreDebug_DEMCR_TRCENA_Msk) != 0 && (HOST_DWT.CTRL.Value & DWT_CTRL_CYCCNTENA_Msk) != 0;
+}
+
+/// @brief The cycle counter runs at the simulated core clock, paced by the host's steady clock
+uint32_t CycleCount()
+{
+	if (!CycleCounterRunning())
+		return HOST_DWT.CYCCNT.Value;
+
+	if (cycleCounterVirtual)
+		return HOST_DWT.CYCCNT.Value + (uint32_t)(virtualCycles - cycleEpochVirtual);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - cycleEpoch).count();
+	return HOST_DWT.CYCCNT.Value + (uint32_t)((uint64_t)elapsed * sysClock / 1000000000);
+}
+
+/// @brief Latch the running cycle count so a change to the counter or its time base continues from the right value
+void LatchCycleCount(uint32_t count)
+{
+	HOST_DWT.CYCCNT.Value = count;
+	cycleEpoch            = std::chrono::steady_clock::now();
+	cycleEpochVirtual     = virtualCycles;
+}
+
+GPIO_TypeDef* FindGpio(const volatile void* reg, size_t* index, size_t* offset)
+{
+	uintptr_t address = (uintptr_t)reg;
+	for (size_t i = 0; i < sizeof(gpioPorts) / sizeof(gpioPorts[0]); i++)
+	{
+		uintptr_t base = (uintptr_t)gpioPorts[i];
+		if (address >= base && address < base + sizeof(GPIO_TypeDef))
+		{
+			*index  = i;
+			*offset = address - base;
+			return gpioPorts[i];
+		}
+	}
+
+	return nullptr;
+}
+
+/// @brief Output pins read back what they drive, every other pin reads the level driven from outside
+void UpdateGpioInputs(size_t index)
+{
+	GPIO_TypeDef* port = gpioPorts[index];
+	uint32_t moder     = port->MODER.Value;
+
+	uint32_t outputs = 0;
+	for (uint32_t pin = 0; pin < 16; pin++)
+	{
+		if (((moder >> (2 * pin)) & 0x3U) == GPIO_MODE_OUTPUT)
+			outputs |= 1U << pin;
+	}
+
+	port->IDR.Value = (port->ODR.Value & outputs) | (gpioInputs[index] & ~outputs & 0xFFFFU);
+}
+
+void WriteGpio(size_t index, size_t offset, volatile HostRegister* reg, uint32_t value)
+{
+	GPIO_TypeDef* port = gpioPorts[index];
+
+	if (offset == offsetof(GPIO_TypeDef, BSRR))
+	{
+		// Set takes priority over reset when both bits of a pin are written, BSRR itself always reads as zero
+		port->ODR.Value = (port->ODR.Value & ~(value >> 16)) | (value & 0xFFFFU);
+	}
+	else if (offset != offsetof(GPIO_TypeDef, IDR))
+	{
+		reg->Value = value;
+	}
+
+	UpdateGpioInputs(index);
+}
+
+uint32_t DividerValue(uint32_t divider)
+{
+	switch (divider)
+	{
+	case RCC_HCLK_DIV2:
+		return 2;
+	case RCC_HCLK_DIV4:
+		return 4;
+	case RCC_HCLK_DIV8:
+		return 8;
+	case RCC_HCLK_DIV16:
+		return 16;
+	default:
+		return 1;
+	}
+}
+
+} // namespace
+
+extern "C"
+{
+	uint32_t HOST_RegisterRead(const volatile HostRegister* reg)
+	{
+		void (*hook)(const volatile void* reg) = readHook;
+		if (hook != nullptr)
+		{
+			readHook = nullptr;
+			hook(reg);
+			readHook = hook;
+		}
+
+		if (reg == &HOST_DWT.CYCCNT)
+			return CycleCount();
+
+		return reg->Value;
+	}
+
+	void HOST_SetRegisterReadHook(void (*hook)(const volatile void* reg))
+	{
+		readHook = hook;
+	}
+
+	void HOST_RegisterWrite(volatile HostRegister* reg, uint32_t value)
+	{
+		size_t offset         = 0;
+		SimulatedTimer* timer = FindTimer(reg, &offset);
+
+		size_t gpioIndex;
+		size_t gpioOffset;
+		if (FindGpio(reg, &gpioIndex, &gpioOffset) != nullptr)
+			WriteGpio(gpioIndex, gpioOffset, reg, value);
+		else if (timer != nullptr && offset == offsetof(TIM_TypeDef, SR))
+			reg->Value = reg->Value & value; // Status flags are cleared by writing zero
+		else if (timer != nullptr && offset == offsetof(TIM_TypeDef, EGR))
+			GenerateEvents(*timer, value);
+		else if (timer != nullptr && offset == offsetof(TIM_TypeDef, ARR))
+		{
+			// Without auto-reload preload a new period takes effect immediately
+			reg->Value = value;
+			if ((timer->Tim->CR1.Value & TIM_CR1_ARPE) == 0)
+				timer->AutoReload = value;
+		}
+		else if (reg == &HOST_DWT.CYCCNT || reg == &HOST_DWT.CTRL)
+		{
+			uint32_t count = CycleCount();
+			reg->Value     = value;
+			LatchCycleCount(reg == &HOST_DWT.CYCCNT ? value : count);
+		}
+		else
+			reg->Value = value;
+	}
+
+	uint32_t HOST_GetPrimask(void)
+	{
+		return primask;
+	}
+
+	void HOST_SetPrimask(uint32_t value)
+	{
+		primask = value & 1;
+		if (primask != 0)
+			return;
+
+		for (SimulatedTimer& timer : timers)
+		{
+			if (timer.Tim != nullptr && timer.Pending)
+				RaiseInterrupt(timer);
+		}
+
+		HOST_UART_Advance(virtualCycles);
+	}
+
+	void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef* clkConfig, uint32_t* flashLatency)
+	{
+		clkConfig->ClockType      = 0;
+		clkConfig->SYSCLKSource   = 0;
+		clkConfig->AHBCLKDivider  = 0;
+		clkConfig->APB1CLKDivider = apb1Divider;
+		clkConfig->APB2CLKDivider = apb2Divider;
+		*flashLatency             = 0;
+	}
+
+	uint32_t HAL_RCC_GetSysClockFreq(void) { return sysClock; }
+	uint32_t HAL_RCC_GetHCLKFreq(void) { return sysClock; }
+	uint32_t HAL_RCC_GetPCLK1Freq(void) { return sysClock / DividerValue(apb1Divider); }
+	uint32_t HAL_RCC_GetPCLK2Freq(void) { return sysClock / DividerValue(apb2Divider); }
+
+	void HOST_RCC_SetClocks(uint32_t sysClockFrequency, uint32_t apb1, uint32_t apb2)
+	{
+		LatchCycleCount(CycleCount());
+
+		sysClock    = sysClockFrequency;
+		apb1Divider = apb1;
+		apb2Divider = apb2;
+
+		// Remainders are kept in units of the old clock
+		tickRemainder = 0;
+		for (SimulatedTimer& timer : timers)
+			timer.InputRemainder = 0;
+	}
+
+	void HOST_TIM_Attach(TIM_TypeDef* tim, void (*irqHandler)(void))
+	{
+		for (SimulatedTimer& timer : timers)
+		{
+			if (timer.Tim == tim || timer.Tim == nullptr)
+			{
+				timer = SimulatedTimer { tim, irqHandler, false, false, 0, 0, tim->PSC.Value & 0xFFFFU, tim->ARR.Value };
+				return;
+			}
+		}
+	}
+
+	void HOST_TIM_Detach(TIM_TypeDef* tim)
+	{
+		for (SimulatedTimer& timer : timers)
+		{
+			if (timer.Tim == tim)
+				timer = SimulatedTimer {};
+		}
+	}
+
+	void HOST_TIM_Advance(TIM_TypeDef* tim, uint32_t ticks)
+	{
+		size_t offset;
+		SimulatedTimer* timer = FindTimer(tim, &offset);
+
+		for (uint32_t i = 0; i < ticks; i++)
+		{
+			if ((tim->CR1.Value & TIM_CR1_CEN) == 0)
+				return;
+
+			uint32_t flags      = 0;
+			uint32_t count      = tim->CNT.Value;
+			uint32_t autoReload = timer != nullptr ? timer->AutoReload : tim->ARR.Value;
+			// A counter set above ARR keeps counting until it overflows, like the hardware
+			if (count == autoReload || count == UINT32_MAX)
+			{
+				count = 0;
+				if ((tim->CR1.Value & TIM_CR1_UDIS) == 0)
+				{
+					flags |= TIM_SR_UIF;
+					if (timer != nullptr)
+						LoadShadowRegisters(*timer);
+				}
+			}
+			else
+			{
+				count++;
+			}
+			tim->CNT.Value = count;
+
+			if (count == tim->CCR1.Value)
+				flags |= TIM_SR_CC1IF;
+			if (count == tim->CCR2.Value)
+				flags |= TIM_SR_CC2IF;
+			if (count == tim->CCR3.Value)
+				flags |= TIM_SR_CC3IF;
+			if (count == tim->CCR4.Value)
+				flags |= TIM_SR_CC4IF;
+
+			if (flags == 0)
+				continue;
+
+			tim->SR.Value = tim->SR.Value | flags;
+
+			if (timer != nullptr && (flags & TIM_SR_UIF) != 0)
+				ClockSlaves(*timer);
+
+			if (timer != nullptr && (flags & tim->DIER.Value) != 0)
+				RaiseInterrupt(*timer);
+		}
+	}
+
+	GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin)
+	{
+		return (port->IDR & pin) != 0 ? GPIO_PIN_SET : GPIO_PIN_RESET;
+	}
+
+	void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state)
+	{
+		port->BSRR = state == GPIO_PIN_SET ? (uint32_t)pin : (uint32_t)pin << 16;
+	}
+
+	void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin)
+	{
+		uint32_t odr = port->ODR;
+		port->BSRR   = ((odr & pin) << 16) | (~odr & pin);
+	}
+
+	void HOST_GPIO_SetInput(GPIO_TypeDef* port, uint16_t pins, GPIO_PinState state)
+	{
+		size_t index;
+		size_t offset;
+		if (FindGpio(port, &index, &offset) == nullptr)
+			return;
+
+		if (state == GPIO_PIN_SET)
+			gpioInputs[index] |= pins;
+		else
+			gpioInputs[index] &= ~(uint32_t)pins;
+
+		UpdateGpioInputs(index);
+	}
+
+	uint32_t HAL_GetTick(void)
+	{
+		return tickMilliseconds;
+	}
+
+	void HAL_Delay(uint32_t delay)
+	{
+		HOST_AdvanceTime((uint64_t)delay * sysClock / 1000);
+	}
+
+	void HOST_Nop(void)
+	{
+		HOST_AdvanceTime(sysClock / 1000000);
+	}
+
+	uint64_t HOST_GetTime(void)
+	{
+		return virtualCycles;
+	}
+
+	void HOST_AdvanceTime(uint64_t cycles)
+	{
+		uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+		if (apb1Divider != RCC_HCLK_DIV1)
+			timerClock *= 2;
+
+		while (cycles > 0)
+		{
+			uint64_t step = cycles < MaxTimeStep ? cycles : MaxTimeStep;
+
+			// Stop at the next serial line event so its callback is raised on time
+			uint64_t nextEvent = HOST_UART_GetNextEvent();
+			if (nextEvent > virtualCycles && nextEvent - virtualCycles < step)
+				step = nextEvent - virtualCycles;
+			cycles -= step;
+			virtualCycles += step;
+
+			tickRemainder += step * 1000;
+			tickMilliseconds += (uint32_t)(tickRemainder / sysClock);
+			tickRemainder %= sysClock;
+
+			for (SimulatedTimer& timer : timers)
+			{
+				TIM_TypeDef* tim = timer.Tim;
+				// Slaves are clocked by their master's trigger instead
+				if (tim == nullptr || (tim->CR1.Value & TIM_CR1_CEN) == 0 || (tim->SMCR.Value & TIM_SMCR_SMS) == TIM_SLAVEMODE_EXTERNAL1)
+					continue;
+
+				timer.InputRemainder += step * timerClock;
+				timer.PrescalerCycles += timer.InputRemainder / sysClock;
+				timer.InputRemainder %= sysClock;
+
+				// Advance up to each update event at a time, since it can load a new prescaler
+				while ((tim->CR1.Value & TIM_CR1_CEN) != 0)
+				{
+					uint64_t prescaler = (uint64_t)timer.Prescaler + 1;
+					uint64_t ticks     = timer.PrescalerCycles / prescaler;
+					if (ticks == 0)
+						break;
+
+					uint32_t count       = tim->CNT.Value;
+					uint64_t untilUpdate = count <= timer.AutoReload ? (uint64_t)timer.AutoReload - count + 1 : (uint64_t)UINT32_MAX - count + 1;
+					if (ticks > untilUpdate)
+						ticks = untilUpdate;
+					if (ticks > UINT32_MAX)
+						ticks = UINT32_MAX;
+
+					timer.PrescalerCycles -= ticks * prescaler;
+					HOST_TIM_Advance(tim, (uint32_t)ticks);
+				}
+
+				// A timer stopped part way through loses the rest of the step, like the ticks its counter missed
+				if ((tim->CR1.Value & TIM_CR1_CEN) == 0)
+					timer.PrescalerCycles %= (uint64_t)timer.Prescaler + 1;
+			}
+
+			HOST_UART_Advance(virtualCycles);
+		}
+	}
+
+	void HOST_SetCycleCounterSource(int useVirtualClock)
+	{
+		LatchCycleCount(CycleCount());
+		cycleCounterVirtual = useVirtualClock != 0;
+	}
+}
@@ -0,0 +1,401 @@
+/**
+ * @file stm32hostxx_hal_uart.cpp
+ * @author Purdue Solar Racing
+ * @brief Serial line simulation behind the host HAL UART functions
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "stm32hostxx_hal.h"
+#include "stm32hostxx_internal.h"
+
+#include <cstddef>
+
+USART_TypeDef HOST_USART1 = {};
+USART_TypeDef HOST_USART2 = {};
+USART_TypeDef HOST_USART3 = {};
+
+namespace
+{
+
+constexpr size_t MaxUarts   = 8;
+constexpr size_t BufferSize = 4096;
+
+/// @brief A byte FIFO that drops what does not fit
+struct ByteFifo
+{
+	uint8_t Data[BufferSize];
+	size_t Head;
+	size_t Count;
+
+	size_t Push(const uint8_t* data, size_t size)
+	{
+		size_t pushed = 0;
+		for (; pushed < size && Count < BufferSize; pushed++, Count++)
+			Data[(Head + Count) % BufferSize] = data[pushed];
+
+		return pushed;
+	}
+
+	size_t Pop(uint8_t* data, size_t size)
+	{
+		size_t popped = 0;
+		for (; popped < size && Count > 0; popped++, Count--, Head = (Head + 1) % BufferSize)
+			data[popped] = Data[Head];
+
+		return popped;
+	}
+};
+
+struct SimulatedUart
+{
+	UART_HandleTypeDef* Handle;
+	/// @brief Bytes sent by the firmware, waiting to be taken by the test
+	ByteFifo Transmitted;
+	/// @brief Bytes injected by the test, waiting to be received by the firmware
+	ByteFifo Received;
+
+	/// @brief An interrupt or DMA transmit is running
+	bool Transmitting;
+	/// @brief The virtual time the running transmit started
+	uint64_t TransmitStart;
+	/// @brief The transmit finished while interrupts were masked or a callback was running
+	bool TransmitPending;
+
+	/// @brief A receive to idle DMA reception is running
+	bool Receiving;
+	/// @brief The virtual time the byte on the receive line finishes arriving, 0 while the line is idle
+	uint64_t ByteEnd;
+	/// @brief The virtual time the last byte arrived
+	uint64_t LastByte;
+	/// @brief Bytes arrived since the last event, so the line going idle raises one
+	bool IdleArmed;
+	/// @brief A receive event is waiting for its callback, reporting `EventSize`
+	bool EventPending;
+	uint16_t EventSize;
+};
+
+SimulatedUart uarts[MaxUarts];
+/// @brief A UART callback is running, callbacks do not nest
+bool callbackActive = false;
+
+SimulatedUart* FindUart(UART_HandleTypeDef* huart)
+{
+	for (SimulatedUart& uart : uarts)
+	{
+		if (uart.Handle == huart)
+			return &uart;
+	}
+
+	for (SimulatedUart& uart : uarts)
+	{
+		if (uart.Handle == nullptr)
+		{
+			uart.Handle = huart;
+			return &uart;
+		}
+	}
+
+	return nullptr;
+}
+
+/// @brief The number of core clock cycles a number of bytes take on the line, with a start and a stop bit
+uint64_t LineTime(UART_HandleTypeDef* huart, size_t size)
+{
+	if (huart->Init.BaudRate == 0)
+		return 0;
+
+	return (uint64_t)size * 10 * HAL_RCC_GetHCLKFreq() / huart->Init.BaudRate;
+}
+
+/// @brief Run a HAL callback the way the UART interrupt handler would
+template <typename Callback>
+void RaiseCallback(SimulatedUart& uart, Callback callback)
+{
+	uint32_t icsr = HOST_SCB.ICSR;
+	HOST_SCB.ICSR = (icsr & ~SCB_ICSR_VECTACTIVE_Msk) | (HOST_UART_IRQ_BASE + (uint32_t)(&uart - uarts));
+	callbackActive = true;
+
+	callback();
+
+	callbackActive = false;
+	HOST_SCB.ICSR  = icsr;
+}
+
+/// @brief Move the bytes of a running transmit onto the line as their time passes
+void AdvanceTransmit(SimulatedUart& uart, uint64_t now)
+{
+	UART_HandleTypeDef* huart = uart.Handle;
+	if (!uart.Transmitting)
+		return;
+
+	size_t sent = huart->TxXferSize - huart->TxXferCount;
+	size_t due  = huart->TxXferSize;
+	if (now - uart.TransmitStart < LineTime(huart, huart->TxXferSize))
+	{
+		uint64_t elapsed = (now - uart.TransmitStart) * huart->Init.BaudRate / (10 * (uint64_t)HAL_RCC_GetHCLKFreq());
+		due              = elapsed < due ? (size_t)elapsed : due;
+	}
+
+	if (due > sent)
+	{
+		uart.Transmitted.Push(huart->pTxBuffPtr + sent, due - sent);
+		huart->TxXferCount = (uint16_t)(huart->TxXferSize - due);
+	}
+
+	if (due == huart->TxXferSize)
+	{
+		uart.Transmitting    = false;
+		uart.TransmitPending = true;
+		huart->gState        = HAL_UART_STATE_READY;
+	}
+}
+
+void RaiseReceiveEvent(SimulatedUart& uart, uint16_t size)
+{
+	uart.EventPending = true;
+	uart.EventSize    = size;
+	uart.IdleArmed    = false;
+
+	UART_HandleTypeDef* huart = uart.Handle;
+	if (huart->hdmarx == nullptr || huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+	{
+		// Normal mode reception ends at its first event
+		uart.Receiving = false;
+		uart.ByteEnd   = 0;
+		huart->RxState = HAL_UART_STATE_READY;
+	}
+}
+
+/// @brief Move injected bytes into the reception buffer as their time passes
+void AdvanceReceive(SimulatedUart& uart, uint64_t now)
+{
+	UART_HandleTypeDef* huart = uart.Handle;
+	uint64_t byteTime         = LineTime(huart, 1);
+
+	while (uart.Receiving && uart.ByteEnd != 0 && uart.ByteEnd <= now)
+	{
+		// A byte is only in flight while one is waiting, so the pop always succeeds
+		uint8_t byte = 0;
+		uart.Received.Pop(&byte, 1);
+
+		size_t index             = huart->RxXferSize - huart->RxXferCount;
+		huart->pRxBuffPtr[index] = byte;
+		huart->RxXferCount       = huart->RxXferCount - 1;
+
+		uart.LastByte  = uart.ByteEnd;
+		uart.ByteEnd   = uart.Received.Count > 0 ? uart.ByteEnd + byteTime : 0;
+		uart.IdleArmed = true;
+
+		if (huart->RxXferCount == 0)
+		{
+			// Circular reception wraps around to the start of the buffer
+			huart->RxXferCount = huart->RxXferSize;
+			RaiseReceiveEvent(uart, huart->RxXferSize);
+		}
+		else if (index + 1 == huart->RxXferSize / 2u)
+		{
+			RaiseReceiveEvent(uart, (uint16_t)(index + 1));
+		}
+	}
+
+	if (uart.Receiving && uart.IdleArmed && uart.ByteEnd == 0 && now >= uart.LastByte + byteTime)
+		RaiseReceiveEvent(uart, huart->RxXferSize - huart->RxXferCount);
+}
+
+HAL_StatusTypeDef StartTransmit(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+{
+	SimulatedUart* uart = FindUart(huart);
+	if (uart == nullptr || data == nullptr || size == 0)
+		return HAL_ERROR;
+
+	if (huart->gState != HAL_UART_STATE_READY && huart->gState != HAL_UART_STATE_RESET)
+		return HAL_BUSY;
+
+	huart->gState      = HAL_UART_STATE_BUSY_TX;
+	huart->pTxBuffPtr  = data;
+	huart->TxXferSize  = size;
+	huart->TxXferCount = size;
+
+	uart->Transmitting  = true;
+	uart->TransmitStart = HOST_GetTime();
+
+	return HAL_OK;
+}
+
+} // namespace
+
+extern "C"
+{
+	HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr || data == nullptr || size == 0)
+			return HAL_ERROR;
+
+		if (huart->gState != HAL_UART_STATE_READY && huart->gState != HAL_UART_STATE_RESET)
+			return HAL_BUSY;
+
+		// The simulated line never stalls, so the transfer always finishes within its line time
+		(void)timeout;
+
+		huart->gState = HAL_UART_STATE_BUSY_TX;
+		HOST_AdvanceTime(LineTime(huart, size));
+		uart->Transmitted.Push(data, size);
+		huart->gState = HAL_UART_STATE_READY;
+
+		return HAL_OK;
+	}
+
+	HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+	{
+		return StartTransmit(huart, data, size);
+	}
+
+	HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+	{
+		return StartTransmit(huart, data, size);
+	}
+
+	__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart)
+	{
+		(void)huart;
+	}
+
+	HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr || data == nullptr || size == 0)
+			return HAL_ERROR;
+
+		if (huart->RxState != HAL_UART_STATE_READY && huart->RxState != HAL_UART_STATE_RESET)
+			return HAL_BUSY;
+
+		huart->RxState       = HAL_UART_STATE_BUSY_RX;
+		huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+		huart->pRxBuffPtr    = data;
+		huart->RxXferSize    = size;
+		huart->RxXferCount   = size;
+
+		uart->Receiving    = true;
+		uart->IdleArmed    = false;
+		uart->EventPending = false;
+		if (uart->Received.Count > 0)
+			uart->ByteEnd = HOST_GetTime() + LineTime(huart, 1);
+
+		return HAL_OK;
+	}
+
+	HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr)
+			return HAL_ERROR;
+
+		uart->Receiving    = false;
+		uart->ByteEnd      = 0;
+		uart->EventPending = false;
+
+		huart->RxState       = HAL_UART_STATE_READY;
+		huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+
+		return HAL_OK;
+	}
+
+	__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t size)
+	{
+		(void)huart;
+		(void)size;
+	}
+
+	HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* huart, uint8_t* data, uint16_t size, uint32_t timeout)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr || data == nullptr || size == 0)
+			return HAL_ERROR;
+
+		if (huart->RxState != HAL_UART_STATE_READY && huart->RxState != HAL_UART_STATE_RESET)
+			return HAL_BUSY;
+
+		if (uart->Received.Pop(data, size) == size)
+			return HAL_OK;
+
+		if (timeout != HAL_MAX_DELAY)
+			HAL_Delay(timeout);
+
+		return HAL_TIMEOUT;
+	}
+
+	size_t HOST_UART_Inject(UART_HandleTypeDef* huart, const uint8_t* data, size_t size)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr)
+			return 0;
+
+		// A byte starts arriving right away if the line was idle
+		if (uart->Receiving && uart->ByteEnd == 0 && uart->Received.Count == 0 && size > 0)
+			uart->ByteEnd = HOST_GetTime() + LineTime(huart, 1);
+
+		return uart->Received.Push(data, size);
+	}
+
+	size_t HOST_UART_TakeTransmitted(UART_HandleTypeDef* huart, uint8_t* data, size_t size)
+	{
+		SimulatedUart* uart = FindUart(huart);
+		if (uart == nullptr)
+			return 0;
+
+		return uart->Transmitted.Pop(data, size);
+	}
+}
+
+void HOST_UART_Advance(uint64_t now)
+{
+	for (SimulatedUart& uart : uarts)
+	{
+		if (uart.Handle == nullptr)
+			continue;
+
+		AdvanceTransmit(uart, now);
+		AdvanceReceive(uart, now);
+
+		if (uart.TransmitPending && HOST_GetPrimask() == 0 && !callbackActive)
+		{
+			uart.TransmitPending = false;
+			RaiseCallback(uart, [&] { HAL_UART_TxCpltCallback(uart.Handle); });
+		}
+
+		if (uart.EventPending && HOST_GetPrimask() == 0 && !callbackActive)
+		{
+			uart.EventPending = false;
+			RaiseCallback(uart, [&] { HAL_UARTEx_RxEventCallback(uart.Handle, uart.EventSize); });
+		}
+	}
+}
+
+uint64_t HOST_UART_GetNextEvent(void)
+{
+	uint64_t next = UINT64_MAX;
+	for (SimulatedUart& uart : uarts)
+	{
+		if (uart.Handle == nullptr)
+			continue;
+
+		if (uart.Transmitting)
+		{
+			uint64_t end = uart.TransmitStart + LineTime(uart.Handle, uart.Handle->TxXferSize);
+			if (end < next)
+				next = end;
+		}
+
+		if (uart.Receiving)
+		{
+			uint64_t event = uart.ByteEnd != 0 ? uart.ByteEnd : (uart.IdleArmed ? uart.LastByte + LineTime(uart.Handle, 1) : UINT64_MAX);
+			if (event < next)
+				next = event;
+		}
+	}
+
+	return next;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file stm32hostxx_internal.h
+ * @author Purdue Solar Racing
+ * @brief Hooks between the parts of the host HAL simulation, not part of the simulated HAL
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __STM32HOSTXX_INTERNAL_H
+#define __STM32HOSTXX_INTERNAL_H
+
+#include <stdint.h>
+
+/// @brief The interrupt number reported through `SCB->ICSR` while a simulated UART callback runs, offset by the UART index
+#define HOST_UART_IRQ_BASE 64U
+
+/**
+ * @brief Move the simulated serial lines forward to the virtual time `now`, raising the UART callbacks that are due
+ * @remark Called by the virtual clock after every step and when interrupts are unmasked
+ */
+void HOST_UART_Advance(uint64_t now);
+
+/**
+ * @brief Get the virtual time of the next UART event
+ * @remark The virtual clock never steps past it, so callbacks are raised at the right time
+ *
+ * @return `uint64_t` The time in core clock cycles, `UINT64_MAX` if no transfer is running
+ */
+uint64_t HOST_UART_GetNextEvent(void);
+
+#endif // End of include guard for stm32hostxx_internal.h
@@ -0,0 +1,81 @@
+/**
+ * @file atomic_operations.hpp
+ * @author Purdue Solar Racing
+ * @brief Read-modify-write operations on atomics that are safe to use from interrupts on every Cortex-M core
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// ARMv6-M (Cortex-M0 and M0+) has no exclusive load and store, so the compiler turns atomic read-modify-writes into
+// library calls that may take a lock or not exist at all. Masking interrupts is atomic on these single core parts
+#if defined(__ARM_ARCH_6M__)
+#include "critical_section.h"
+#define ATOMIC_OPERATIONS_CRITICAL_SECTION
+#endif
+
+namespace PSR
+{
+
+// Plain loads and stores are used directly, they are single instructions on every core
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Loads and stores of a 32-bit atomic must not take a lock");
+
+/**
+ * @brief Replace the value of an atomic if it equals the expected value
+ * @remark Never fails spuriously, unlike `compare_exchange_weak`
+ *
+ * @param atomic The atomic to change
+ * @param expected The value the atomic is expected to hold, set to the value it held when the exchange fails
+ * @param desired The value to store
+ * @param order The memory order of the exchange
+ * @return `bool` Whether the value was replaced
+ */
+inline bool atomicCompareExchange(std::atomic<uint32_t>& atomic, uint32_t& expected, uint32_t desired,
+                                  std::memory_order order = std::memory_order_seq_cst)
+{
+#ifdef ATOMIC_OPERATIONS_CRITICAL_SECTION
+	(void)order;
+	uint32_t primask = EnterCriticalSection();
+	uint32_t current = atomic.load(std::memory_order_relaxed);
+	bool exchanged   = current == expected;
+	if (exchanged)
+		atomic.store(desired, std::memory_order_relaxed);
+	else
+		expected = current;
+	ExitCriticalSection(primask);
+
+	return exchanged;
+#else
+	return atomic.compare_exchange_strong(expected, desired, order, std::memory_order_relaxed);
+#endif
+}
+
+/**
+ * @brief Add to an atomic
+ *
+ * @param atomic The atomic to change
+ * @param value The value to add
+ * @param order The memory order of the addition
+ * @return `uint32_t` The value before the addition
+ */
+inline uint32_t atomicFetchAdd(std::atomic<uint32_t>& atomic, uint32_t value, std::memory_order order = std::memory_order_seq_cst)
+{
+#ifdef ATOMIC_OPERATIONS_CRITICAL_SECTION
+	(void)order;
+	uint32_t primask  = EnterCriticalSection();
+	uint32_t previous = atomic.load(std::memory_order_relaxed);
+	atomic.store(previous + value, std::memory_order_relaxed);
+	ExitCriticalSection(primask);
+
+	return previous;
+#else
+	return atomic.fetch_add(value, order);
+#endif
+}
+
+} // namespace PSR
@@ -2,7 +2,7 @@
  * @file bit_operations.h
  * @author Purdue Solar Racing (Aidan Orr)
  * @brief Implementation of common bit-level operations for all integer types
- * @version 0.3
+ * @version 0.4
  *
  * @copyright Copyright (c) 2023
  *
@@ -12,6 +12,7 @@
 #define __BIT_OPERATIONS_H
 
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -168,30 +169,244 @@ constexpr
 
 /**
  * @brief Count the number of leading zeros in an integer
- * 
+ * @remark Uses the instruction for the width of `T`, CLZ on Cortex-M3 and above
+ *
  * @tparam T the integer type of the value
  * @param value the value to count leading zeros in
- * @return int the number of leading zeros
+ * @return int the number of leading zeros, the bit width of `T` if the value is 0
  */
 template <typename T>
 constexpr int countLeadingZeros(T value)
 {
 	__ASSERT_INTEGRAL(T);
-    return __builtin_clz(value);
+	using uT           = typename std::make_unsigned<T>::type;
+	constexpr int bits = CHAR_BIT * sizeof(uT);
+	uT uv              = (uT)value;
+
+	if (uv == 0)
+		return bits;
+
+	if (sizeof(uT) <= sizeof(unsigned int))
+		return __builtin_clz((unsigned int)uv) - (int)(CHAR_BIT * sizeof(unsigned int) - bits);
+	else if (sizeof(uT) <= sizeof(unsigned long))
+		return __builtin_clzl((unsigned long)uv) - (int)(CHAR_BIT * sizeof(unsigned long) - bits);
+	else
+		return __builtin_clzll((unsigned long long)uv) - (int)(CHAR_BIT * sizeof(unsigned long long) - bits);
 }
 
 /**
  * @brief Count the number of trailing zeros in an integer
- * 
+ * @remark Uses the instruction for the width of `T`, RBIT and CLZ on Cortex-M3 and above
+ *
  * @tparam T the integer type of the value
  * @param value the value to count trailing zeros in
- * @return int the number of trailing zeros
+ * @return int the number of trailing zeros, the bit width of `T` if the value is 0
  */
 template <typename T>
 constexpr int countTrailingZeros(T value)
 {
 	__ASSERT_INTEGRAL(T);
-    return __builtin_ctz(value);
+	using uT           = typename std::make_unsigned<T>::type;
+	constexpr int bits = CHAR_BIT * sizeof(uT);
+	uT uv              = (uT)value;
+
+	if (uv == 0)
+		return bits;
+
+	if (sizeof(uT) <= sizeof(unsigned int))
+		return __builtin_ctz((unsigned int)uv);
+	else if (sizeof(uT) <= sizeof(unsigned long))
+		return __builtin_ctzl((unsigned long)uv);
+	else
+		return __builtin_ctzll((unsigned long long)uv);
+}
+
+/**
+ * @brief Count the number of set bits in an integer
+ *
+ * @tparam T the integer type of the value
+ * @param value the value to count bits in
+ * @return int the number of bits set to 1
+ */
+template <typename T>
+constexpr int popCount(T value)
+{
+	__ASSERT_INTEGRAL(T);
+	using uT = typename std::make_unsigned<T>::type;
+	uT uv    = (uT)value;
+
+	if (sizeof(uT) <= sizeof(unsigned int))
+		return __builtin_popcount((unsigned int)uv);
+	else if (sizeof(uT) <= sizeof(unsigned long))
+		return __builtin_popcountl((unsigned long)uv);
+	else
+		return __builtin_popcountll((unsigned long long)uv);
+}
+
+/**
+ * @brief Get the parity of an integer
+ *
+ * @tparam T the integer type of the value
+ * @param value the value to get the parity of
+ * @return int 1 if an odd number of bits are set, otherwise 0
+ */
+template <typename T>
+constexpr int parity(T value)
+{
+	__ASSERT_INTEGRAL(T);
+	using uT = typename std::make_unsigned<T>::type;
+	uT uv    = (uT)value;
+
+	if (sizeof(uT) <= sizeof(unsigned int))
+		return __builtin_parity((unsigned int)uv);
+	else if (sizeof(uT) <= sizeof(unsigned long))
+		return __builtin_parityl((unsigned long)uv);
+	else
+		return __builtin_parityll((unsigned long long)uv);
+}
+
+/**
+ * @brief Find the least significant set bit of an integer
+ * @remark Follows `ffs`, the position is 1-based so that 0 can mean no bit is set. The bit array scans
+ * `findFirstSetIndex` and `findFirstClearIndex` return 0-based indices instead
+ *
+ * @tparam T the integer type of the value
+ * @param value the value to search
+ * @return int one more than the index of the least significant set bit, 0 if the value is 0
+ */
+template <typename T>
+constexpr int findFirstSet(T value)
+{
+	__ASSERT_INTEGRAL(T);
+	return value == 0 ? 0 : countTrailingZeros(value) + 1;
+}
+
+/// @brief The word type of bit arrays, the widest integer the processor handles in one register
+using BitWord = std::conditional<(sizeof(void*) >= 8), uint64_t, uint32_t>::type;
+
+/**
+ * @brief Get the number of words needed to hold a number of bits
+ *
+ * @tparam T the unsigned integer type of the words
+ * @param bitCount the number of bits
+ * @return size_t the number of words
+ */
+template <typename T = BitWord>
+constexpr size_t bitArrayWords(size_t bitCount)
+{
+	return (bitCount + CHAR_BIT * sizeof(T) - 1) / (CHAR_BIT * sizeof(T));
+}
+
+/**
+ * @brief Count the set bits of a bit array, bit `i` is bit `i % width` of word `i / width`
+ *
+ * @tparam T the unsigned integer type of the words
+ * @param words the bit array
+ * @param bitCount the number of bits in the array, bits of the last word past it are ignored
+ * @return size_t the number of bits set to 1
+ */
+template <typename T>
+size_t popCount(const T* words, size_t bitCount)
+{
+	static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type.");
+	constexpr size_t bits = CHAR_BIT * sizeof(T);
+
+	size_t fullWords = bitCount / bits;
+	size_t count     = 0;
+	for (size_t i = 0; i < fullWords; i++)
+		count += popCount(words[i]);
+
+	if (bitCount % bits != 0)
+		count += popCount((T)(words[fullWords] & (((T)1 << (bitCount % bits)) - 1)));
+
+	return count;
+}
+
+/**
+ * @brief Call a function with the index of every set bit of a bit array, in increasing order
+ * @remark Costs one step per word plus one per set bit, so sparse arrays are cheap to walk
+ *
+ * @tparam T the unsigned integer type of the words
+ * @tparam F the function type, called as `callback(size_t index)`
+ * @param words the bit array
+ * @param bitCount the number of bits in the array, bits of the last word past it are ignored
+ * @param callback the function to call
+ */
+template <typename T, typename F>
+void forEachSetBit(const T* words, size_t bitCount, F&& callback)
+{
+	static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type.");
+	constexpr size_t bits = CHAR_BIT * sizeof(T);
+
+	size_t wordCount = bitArrayWords<T>(bitCount);
+	for (size_t i = 0; i < wordCount; i++)
+	{
+		T word = words[i];
+		if (i == wordCount - 1 && bitCount % bits != 0)
+			word &= ((T)1 << (bitCount % bits)) - 1;
+
+		while (word != 0)
+		{
+			callback(i * bits + countTrailingZeros(word));
+			word &= word - 1; // Clear the lowest set bit
+		}
+	}
+}
+
+/**
+ * @brief Find the index of the first set bit of a bit array
+ * @remark The index is 0-based, unlike the 1-based position `findFirstSet` returns for a single integer
+ *
+ * @tparam T the unsigned integer type of the words
+ * @param words the bit array
+ * @param bitCount the number of bits in the array
+ * @return size_t the index of the first set bit, `bitCount` if there is none
+ */
+template <typename T>
+size_t findFirstSetIndex(const T* words, size_t bitCount)
+{
+	static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type.");
+	constexpr size_t bits = CHAR_BIT * sizeof(T);
+
+	size_t wordCount = bitArrayWords<T>(bitCount);
+	for (size_t i = 0; i < wordCount; i++)
+	{
+		if (words[i] != 0)
+		{
+			size_t index = i * bits + countTrailingZeros(words[i]);
+			return index < bitCount ? index : bitCount;
+		}
+	}
+
+	return bitCount;
+}
+
+/**
+ * @brief Find the index of the first clear bit of a bit array, such as a free slot in an allocation mask
+ *
+ * @tparam T the unsigned integer type of the words
+ * @param words the bit array
+ * @param bitCount the number of bits in the array
+ * @return size_t the index of the first clear bit, `bitCount` if every bit is set
+ */
+template <typename T>
+size_t findFirstClearIndex(const T* words, size_t bitCount)
+{
+	static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type.");
+	constexpr size_t bits = CHAR_BIT * sizeof(T);
+
+	size_t wordCount = bitArrayWords<T>(bitCount);
+	for (size_t i = 0; i < wordCount; i++)
+	{
+		T inverted = (T)~words[i];
+		if (inverted != 0)
+		{
+			size_t index = i * bits + countTrailingZeros(inverted);
+			return index < bitCount ? index : bitCount;
+		}
+	}
+
+	return bitCount;
 }
 
 /**
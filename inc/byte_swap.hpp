@@ -0,0 +1,229 @@
+/**
+ * @file byte_swap.hpp
+ * @author Purdue Solar Racing
+ * @brief Byte order conversion of whole buffers of 16, 32 and 64-bit values
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "bit_operations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace PSR
+{
+
+namespace Detail
+{
+
+/**
+ * @brief Reverse the bytes of each `Size` byte element packed in a word
+ * @remark The mask and shift form for 16-bit elements is turned into REV16 on Cortex-M, the others into REV
+ */
+template <size_t Size, typename W>
+inline W SwapElements(W word)
+{
+	if constexpr (Size == 2)
+	{
+		constexpr W lowBytes = (W)0x00FF00FF00FF00FFull;
+		return ((word & lowBytes) << 8) | ((word >> 8) & lowBytes);
+	}
+	else if constexpr (Size == sizeof(W))
+	{
+		return reverseEndianness(word);
+	}
+	else
+	{
+		// Two 32-bit elements in a 64-bit word, reversing the word also swaps the elements, so swap them back
+		static_assert(Size == 4 && sizeof(W) == 8, "Unsupported element size");
+		return rotateLeft(reverseEndianness(word), 32);
+	}
+}
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+/// @brief The byte shuffle that reverses each `Size` byte element of a 32-byte vector
+template <size_t Size>
+struct ShuffleMask
+{
+	alignas(32) uint8_t Bytes[32];
+
+	constexpr ShuffleMask() : Bytes {}
+	{
+		for (size_t i = 0; i < 32; i++)
+			Bytes[i] = (uint8_t)((i % 16) / Size * Size + Size - 1 - i % Size);
+	}
+};
+
+template <size_t Size>
+constexpr ShuffleMask<Size> Shuffle {};
+#endif
+
+} // namespace Detail
+
+/**
+ * @brief Reverse the byte order of every `Size` byte element of a buffer
+ * @remark Neither buffer has to be aligned. The bulk is converted 16 or 32 bytes at a time with SSSE3, AVX2 or NEON byte shuffles
+ * when the host supports them, or with SSE2 word shuffles and shifts on any x86-64 host, then a word at a time with REV or REV16, and the elements left over at the end one at a time.
+ * The buffers must either be the same or not overlap
+ *
+ * @tparam Size The element size in bytes, 2, 4 or 8
+ * @param source The elements to convert
+ * @param destination The buffer to write the converted elements to, may be `source`
+ * @param count The number of elements
+ */
+template <size_t Size>
+void reverseElementBytes(const void* source, void* destination, size_t count)
+{
+	static_assert(Size == 2 || Size == 4 || Size == 8, "Elements must be 2, 4 or 8 bytes");
+
+	const uint8_t* in = (const uint8_t*)source;
+	uint8_t* out      = (uint8_t*)destination;
+	size_t bytes      = count * Size;
+	size_t i          = 0;
+
+#if defined(__AVX2__)
+	const __m256i mask256 = _mm256_load_si256((const __m256i*)Detail::Shuffle<Size>.Bytes);
+	for (; i + 32 <= bytes; i += 32)
+	{
+		__m256i vector = _mm256_loadu_si256((const __m256i*)(in + i));
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(vector, mask256));
+	}
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+	const __m128i mask128 = _mm_load_si128((const __m128i*)Detail::Shuffle<Size>.Bytes);
+	for (; i + 16 <= bytes; i += 16)
+	{
+		__m128i vector = _mm_loadu_si128((const __m128i*)(in + i));
+		_mm_storeu_si128((__m128i*)(out + i), _mm_shuffle_epi8(vector, mask128));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 16 <= bytes; i += 16)
+	{
+		uint8x16_t vector = vld1q_u8(in + i);
+		if constexpr (Size == 2)
+			vector = vrev16q_u8(vector);
+		else if constexpr (Size == 4)
+			vector = vrev32q_u8(vector);
+		else
+			vector = vrev64q_u8(vector);
+		vst1q_u8(out + i, vector);
+	}
+#elif defined(__SSE2__)
+	// Reverse the 16-bit halves of each element with word shuffles, then swap the bytes of every half
+	constexpr int order = Size == 4 ? 0xB1 : 0x1B;
+	for (; i + 16 <= bytes; i += 16)
+	{
+		__m128i vector = _mm_loadu_si128((const __m128i*)(in + i));
+		if constexpr (Size > 2)
+			vector = _mm_shufflehi_epi16(_mm_shufflelo_epi16(vector, order), order);
+		vector = _mm_or_si128(_mm_slli_epi16(vector, 8), _mm_srli_epi16(vector, 8));
+		_mm_storeu_si128((__m128i*)(out + i), vector);
+	}
+#endif
+
+	// memcpy compiles to a single unaligned load or store on cores that allow it and to byte accesses on the others
+	using Word = typename std::conditional<(Size > sizeof(BitWord)), uint64_t, BitWord>::type;
+	for (; i + sizeof(Word) <= bytes; i += sizeof(Word))
+	{
+		Word word;
+		memcpy(&word, in + i, sizeof(word));
+		word = Detail::SwapElements<Size>(word);
+		memcpy(out + i, &word, sizeof(word));
+	}
+
+	using Element = typename std::conditional<Size == 2, uint16_t, typename std::conditional<Size == 4, uint32_t, uint64_t>::type>::type;
+	for (; i < bytes; i += Size)
+	{
+		Element element;
+		memcpy(&element, in + i, Size);
+		element = reverseEndianness(element);
+		memcpy(out + i, &element, Size);
+	}
+}
+
+/**
+ * @brief Reverse the byte order of every value of an array
+ *
+ * @tparam T The value type, an integer or floating point type of 2, 4 or 8 bytes
+ * @param source The values to convert
+ * @param destination The array to write the converted values to, may be `source`
+ * @param count The number of values
+ */
+template <typename T>
+inline void reverseEndianness(const T* source, T* destination, size_t count)
+{
+	static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+	if constexpr (sizeof(T) > 1)
+		reverseElementBytes<sizeof(T)>(source, destination, count);
+	else if (source != destination)
+		memcpy(destination, source, count);
+}
+
+/**
+ * @brief Reverse the byte order of every value of an array in place
+ *
+ * @tparam T The value type, an integer or floating point type of 2, 4 or 8 bytes
+ * @param values The values to convert
+ * @param count The number of values
+ */
+template <typename T>
+inline void reverseEndianness(T* values, size_t count)
+{
+	reverseEndianness<T>(values, values, count);
+}
+
+/**
+ * @brief Convert an array of values between big endian and the processor's byte order, the conversion is the same in both directions
+ *
+ * @tparam T The value type
+ * @param source The values to convert
+ * @param destination The array to write the converted values to, may be `source`
+ * @param count The number of values
+ */
+template <typename T>
+inline void convertBigEndian(const T* source, T* destination, size_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	if (source != destination)
+		memcpy(destination, source, count * sizeof(T));
+#else
+	reverseEndianness(source, destination, count);
+#endif
+}
+
+/**
+ * @brief Convert an array of values between little endian and the processor's byte order, the conversion is the same in both directions
+ *
+ * @tparam T The value type
+ * @param source The values to convert
+ * @param destination The array to write the converted values to, may be `source`
+ * @param count The number of values
+ */
+template <typename T>
+inline void convertLittleEndian(const T* source, T* destination, size_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	reverseEndianness(source, destination, count);
+#else
+	if (source != destination)
+		memcpy(destination, source, count * sizeof(T));
+#endif
+}
+
+} // namespace PSR
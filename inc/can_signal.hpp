@@ -0,0 +1,288 @@
+/**
+ * @file can_signal.hpp
+ * @author Purdue Solar Racing
+ * @brief Compile time CAN signal layouts that generate straight-line encode and decode code
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "bit_operations.h"
+#include "memory_operations.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ratio>
+#include <type_traits>
+
+namespace PSR
+{
+
+/// @brief The bit numbering of a signal, the same as in DBC files
+enum class ByteOrder : uint8_t
+{
+	/// @brief Intel, the start bit is the least significant bit and the signal continues into higher bytes
+	LittleEndian,
+	/// @brief Motorola, the start bit is the most significant bit and the signal continues into lower bits, then the next byte
+	BigEndian,
+};
+
+/**
+ * @brief The layout and scaling of one signal in a CAN frame
+ * @remark Bits are numbered as in DBC files, bit `n` is bit `n % 8` of byte `n / 8`. Signals whose scale is not 1 or whose offset is not 0
+ * are decoded to `float` as `raw * Scale + Offset`, the others to the smallest integer that holds them.
+ * A signal must fit in 8 consecutive bytes, which every signal of up to 57 bits does
+ *
+ * @tparam StartBit The start bit, the least significant bit for little endian and the most significant bit for big endian signals
+ * @tparam Length The number of bits, 1 to 64
+ * @tparam Order The byte order
+ * @tparam Signed Whether the raw value is two's complement
+ * @tparam Scale The physical value of one raw step
+ * @tparam Offset The physical value of a raw value of zero
+ */
+template <size_t StartBit, size_t Length, ByteOrder Order = ByteOrder::LittleEndian, bool Signed = false, typename Scale = std::ratio<1>, typename Offset = std::ratio<0>>
+struct CanSignal
+{
+	static_assert(Length >= 1 && Length <= 64, "Signal length must be between 1 and 64 bits");
+
+	static constexpr bool IsScaled = !(Scale::num == Scale::den && Offset::num == 0);
+
+	using UnsignedRaw = typename std::conditional<(Length <= 32), uint32_t, uint64_t>::type;
+	using RawType     = typename std::conditional<Signed, typename std::make_signed<UnsignedRaw>::type, UnsignedRaw>::type;
+	/// @brief The decoded value type
+	using Type = typename std::conditional<IsScaled, float, RawType>::type;
+
+	static constexpr float ScaleValue  = (float)Scale::num / Scale::den;
+	static constexpr float OffsetValue = (float)Offset::num / Offset::den;
+
+	static constexpr int64_t MinRaw = Signed ? (Length == 64 ? INT64_MIN : -(int64_t)(1ull << (Length - 1))) : 0;
+	static constexpr uint64_t MaxRaw = Signed ? (1ull << (Length - 1)) - 1 : (Length == 64 ? UINT64_MAX : (1ull << Length) - 1);
+
+  private:
+	/// @brief Big endian signals as positions counted from the most significant bit of byte 0
+	static constexpr size_t MsbPosition = (StartBit / 8) * 8 + 7 - StartBit % 8;
+	static constexpr size_t LsbPosition = MsbPosition + Length - 1;
+
+	static constexpr size_t FirstByte = Order == ByteOrder::LittleEndian ? StartBit / 8 : MsbPosition / 8;
+	static constexpr size_t LastByte  = Order == ByteOrder::LittleEndian ? (StartBit + Length - 1) / 8 : LsbPosition / 8;
+
+	static_assert(LastByte - FirstByte < 8, "Signals must fit in 8 consecutive bytes");
+
+	/// @brief The byte offset of the 64-bit word the signal is accessed through, kept inside the frame
+	template <size_t FrameSize>
+	static constexpr size_t Window = FirstByte + 8 <= FrameSize ? FirstByte : FrameSize - 8;
+
+	/// @brief The position of the signal's least significant bit in its word
+	template <size_t FrameSize>
+	static constexpr size_t Shift = Order == ByteOrder::LittleEndian ? StartBit - 8 * Window<FrameSize> : 63 - (LsbPosition - 8 * Window<FrameSize>);
+
+	static constexpr uint64_t Mask = Length == 64 ? UINT64_MAX : (1ull << Length) - 1;
+
+	template <size_t FrameSize>
+	static uint64_t ReadWord(const uint8_t* frame)
+	{
+		if constexpr (Order == ByteOrder::LittleEndian)
+			return readLittleEndian<uint64_t>(frame, Window<FrameSize>);
+		else
+			return readBigEndian<uint64_t>(frame, Window<FrameSize>);
+	}
+
+	template <size_t FrameSize>
+	static void WriteWord(uint8_t* frame, uint64_t word)
+	{
+		if constexpr (Order == ByteOrder::LittleEndian)
+			writeLittleEndian(word, frame, Window<FrameSize>);
+		else
+			writeBigEndian(word, frame, Window<FrameSize>);
+	}
+
+  public:
+	/// @brief Whether the signal lies inside a frame of `FrameSize` bytes
+	template <size_t FrameSize>
+	static constexpr bool FitsIn()
+	{
+		return LastByte < FrameSize;
+	}
+
+	/// @brief Whether the signal uses a bit of the frame, numbered as for little endian start bits
+	static constexpr bool Occupies(size_t bit)
+	{
+		if constexpr (Order == ByteOrder::LittleEndian)
+			return bit >= StartBit && bit < StartBit + Length;
+
+		size_t position = (bit / 8) * 8 + 7 - bit % 8;
+		return position >= MsbPosition && position <= LsbPosition;
+	}
+
+	/**
+	 * @brief Get the raw value of the signal
+	 *
+	 * @tparam FrameSize The size of the frame buffer in bytes, at least 8
+	 * @param frame The frame data
+	 * @return `RawType` The raw value, sign extended if the signal is signed
+	 */
+	template <size_t FrameSize>
+	static RawType DecodeRaw(const uint8_t* frame)
+	{
+		static_assert(FrameSize >= 8, "Frame buffers must be at least 8 bytes");
+		static_assert(FitsIn<FrameSize>(), "Signal does not fit in the frame");
+
+		uint64_t word = ReadWord<FrameSize>(frame);
+		uint64_t raw  = Length == 64 ? word : bitExtract(word, (int)Shift<FrameSize>, (int)Length);
+
+		if constexpr (Signed && Length < 64)
+			return (RawType)((int64_t)(raw << (64 - Length)) >> (64 - Length));
+		else
+			return (RawType)raw;
+	}
+
+	/**
+	 * @brief Get the value of the signal
+	 *
+	 * @tparam FrameSize The size of the frame buffer in bytes, at least 8
+	 * @param frame The frame data
+	 * @return `Type` The physical value if the signal is scaled, otherwise the raw value
+	 */
+	template <size_t FrameSize>
+	static Type Decode(const uint8_t* frame)
+	{
+		RawType raw = DecodeRaw<FrameSize>(frame);
+		if constexpr (IsScaled && Offset::num == 0)
+			return (float)raw * ScaleValue;
+		else if constexpr (IsScaled)
+			return (float)raw * ScaleValue + OffsetValue;
+		else
+			return raw;
+	}
+
+	/**
+	 * @brief Set the raw value of the signal, leaving the other bits of the frame unchanged
+	 *
+	 * @tparam FrameSize The size of the frame buffer in bytes, at least 8
+	 * @param frame The frame data
+	 * @param raw The raw value, truncated to the signal length
+	 */
+	template <size_t FrameSize>
+	static void EncodeRaw(uint8_t* frame, RawType raw)
+	{
+		static_assert(FrameSize >= 8, "Frame buffers must be at least 8 bytes");
+		static_assert(FitsIn<FrameSize>(), "Signal does not fit in the frame");
+
+		uint64_t word = ReadWord<FrameSize>(frame);
+		word          = (word & ~(Mask << Shift<FrameSize>)) | (((uint64_t)raw & Mask) << Shift<FrameSize>);
+		WriteWord<FrameSize>(frame, word);
+	}
+
+	/**
+	 * @brief Set the value of the signal, leaving the other bits of the frame unchanged
+	 * @remark Scaled values are rounded to the nearest raw value and saturate at the ends of the raw range
+	 *
+	 * @tparam FrameSize The size of the frame buffer in bytes, at least 8
+	 * @param frame The frame data
+	 * @param value The physical value if the signal is scaled, otherwise the raw value
+	 */
+	template <size_t FrameSize>
+	static void Encode(uint8_t* frame, Type value)
+	{
+		if constexpr (IsScaled)
+		{
+			float scaled = (value - OffsetValue) * ((float)Scale::den / Scale::num);
+			scaled += scaled < 0 ? -0.5f : 0.5f;
+
+			// Selects instead of branches, so encoding a message stays straight-line code. NaN saturates to the minimum
+			scaled      = scaled > (float)MinRaw ? scaled : (float)MinRaw;
+			RawType raw = scaled >= (float)MaxRaw ? (RawType)MaxRaw : (RawType)scaled;
+
+			EncodeRaw<FrameSize>(frame, raw);
+		}
+		else
+		{
+			EncodeRaw<FrameSize>(frame, value);
+		}
+	}
+};
+
+/**
+ * @brief A CAN frame layout made of signals
+ * @remark Every signal is checked at compile time to lie inside the frame and not to overlap another signal.
+ * Decoding and encoding a whole message expands to one shift and mask per signal on words loaded from the frame,
+ * with no loop over a signal table
+ *
+ * @tparam FrameSize The size of the frame buffer in bytes, 8 for classic CAN and up to 64 for CAN FD
+ * @tparam Signals The `CanSignal` types of the message
+ */
+template <size_t FrameSize, typename... Signals>
+class CanMessage
+{
+  private:
+	static constexpr bool HasOverlap()
+	{
+		for (size_t bit = 0; bit < FrameSize * 8; bit++)
+		{
+			if ((0 + ... + (Signals::Occupies(bit) ? 1 : 0)) > 1)
+				return true;
+		}
+
+		return false;
+	}
+
+	template <typename Signal>
+	static constexpr bool Contains = (std::is_same<Signal, Signals>::value || ...);
+
+	static_assert(FrameSize >= 8 && FrameSize <= 64, "Frame buffers must be between 8 and 64 bytes");
+	static_assert((Signals::template FitsIn<FrameSize>() && ...), "A signal does not fit in the frame");
+	static_assert(!HasOverlap(), "Signals overlap");
+
+  public:
+	static constexpr size_t Size = FrameSize;
+
+	/**
+	 * @brief Decode every signal of a frame
+	 *
+	 * @param frame The frame data
+	 * @param values Set to the value of each signal, in the order of `Signals`
+	 */
+	static void Decode(const uint8_t* frame, typename Signals::Type&... values)
+	{
+		((values = Signals::template Decode<FrameSize>(frame)), ...);
+	}
+
+	/**
+	 * @brief Build a frame from the value of every signal, bits that belong to no signal are zero
+	 *
+	 * @param frame The frame data
+	 * @param values The value of each signal, in the order of `Signals`
+	 */
+	static void Encode(uint8_t* frame, typename Signals::Type... values)
+	{
+		// Built in a local copy the compiler can keep in registers, so the signals are merged before the one store to the frame
+		uint8_t buffer[FrameSize] = {};
+		(Signals::template Encode<FrameSize>(buffer, values), ...);
+		memcpy(frame, buffer, FrameSize);
+	}
+
+	/**
+	 * @brief Decode one signal of a frame
+	 */
+	template <typename Signal>
+	static typename Signal::Type Get(const uint8_t* frame)
+	{
+		static_assert(Contains<Signal>, "The signal is not part of this message");
+		return Signal::template Decode<FrameSize>(frame);
+	}
+
+	/**
+	 * @brief Encode one signal into a frame, leaving the other signals unchanged
+	 */
+	template <typename Signal>
+	static void Set(uint8_t* frame, typename Signal::Type value)
+	{
+		static_assert(Contains<Signal>, "The signal is not part of this message");
+		Signal::template Encode<FrameSize>(frame, value);
+	}
+};
+
+} // namespace PSR
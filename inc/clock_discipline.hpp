@@ -0,0 +1,274 @@
+/**
+ * @file clock_discipline.hpp
+ * @author Purdue Solar Racing
+ * @brief Disciplines a free running microsecond counter to an external time reference
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace PSR
+{
+
+/**
+ * @brief Phase and frequency locked conversion from a raw counter to disciplined time
+ *
+ * @remark Each accepted synchronization sample feeds a PI controller. The integral term learns the crystal's frequency error,
+ * and the proportional term slews out the remaining offset over the next sync interval instead of stepping the time.
+ * The slew ends after that interval, so a late or missing sample cannot overshoot, the learned frequency carries on alone.
+ * Offsets larger than `StepThreshold` are stepped, and samples far outside the measured jitter are rejected as outliers.
+ *
+ * Disciplined time is `anchorTime + d + (d * rate + anchorFraction) / 2^32`, where `d` is the raw time since the anchor,
+ * and past `slewLength` the rest of `d` is corrected by `settledRate` instead. Every rate change re-anchors at the current time,
+ * so the disciplined time never jumps when slewing.
+ *
+ * The anchor is published with a sequence lock for readers on the same core, such as an interrupt reading the time while
+ * the main loop adds a sample. The sequence is odd while the anchor is being written and readers retry until they see the
+ * same even value on both sides of their reads.
+ */
+class ClockDiscipline
+{
+  public:
+	/// @brief Offsets larger than this are stepped instead of slewed, in microseconds
+	static constexpr int64_t StepThreshold = 1000;
+	/// @brief The largest rate correction that will be applied, 500 ppm in units of 2^-32
+	static constexpr int32_t MaxRate = 2147484;
+	/// @brief Samples whose offset is larger than this many times the jitter are rejected
+	static constexpr uint32_t OutlierFactor = 4;
+	/// @brief Samples are never rejected for offsets below this, in microseconds
+	static constexpr uint32_t MinOutlierThreshold = 20;
+	/// @brief A sample is accepted after this many rejections in a row, the reference most likely really moved
+	static constexpr uint32_t MaxConsecutiveRejects = 3;
+	/// @brief The number of accepted samples before outlier rejection starts
+	static constexpr uint32_t SettlingSamples = 4;
+
+	/// @brief Sync quality counters
+	struct Statistics
+	{
+		int32_t LastOffset; ///< @brief Local minus reference time at the last sample, in microseconds
+		int32_t SkewPpb;    ///< @brief The learned frequency correction in parts per billion
+		uint32_t Jitter;    ///< @brief Smoothed absolute offset in microseconds
+		uint32_t Accepted;  ///< @brief The number of samples used
+		uint32_t Rejected;  ///< @brief The number of samples rejected as outliers
+		uint32_t Steps;     ///< @brief The number of times the time was stepped instead of slewed
+	};
+
+  private:
+	static constexpr int32_t ProportionalShift = 1; ///< @brief Slew out half of the offset per sync interval
+	static constexpr int32_t IntegralShift     = 2; ///< @brief Learn a quarter of the implied frequency error per sample
+	static constexpr int32_t JitterShift       = 3; ///< @brief Jitter is an exponential average over roughly 8 samples
+	static constexpr int32_t JitterFraction    = 4; ///< @brief Jitter is stored with 4 fractional bits
+
+	uint64_t anchorRaw      = 0;
+	uint64_t anchorTime     = 0;
+	uint32_t anchorFraction = 0; ///< @brief The sub-microsecond part of the anchor time, so re-anchoring never loses time
+	int32_t rate            = 0; ///< @brief The applied rate correction in units of 2^-32
+	int32_t settledRate     = 0; ///< @brief The rate correction once the slew is over, in units of 2^-32
+	uint64_t slewLength     = 0; ///< @brief The raw time after the anchor when the slew ends, `UINT64_MAX` if there is none
+	int32_t frequency       = 0; ///< @brief The learned frequency correction in units of 2^-32, only used by `AddSample`
+
+	/// @brief Odd while the anchor is being changed, incremented before and after every change so readers can detect a torn read
+	volatile uint32_t sequence = 0;
+
+	uint64_t lastSampleRaw      = 0;
+	bool hasSample              = false;
+	uint32_t consecutiveRejects = 0;
+	uint32_t jitter             = 0;
+
+	Statistics statistics = {};
+
+	static constexpr int32_t Clamp(int64_t value)
+	{
+		return value > MaxRate ? MaxRate : (value < -MaxRate ? -MaxRate : (int32_t)value);
+	}
+
+	/// @brief Get the correction since the anchor in units of 2^-32 microseconds
+	int64_t Correction(uint64_t raw) const
+	{
+		int64_t elapsed = (int64_t)(raw - anchorRaw);
+		if (elapsed <= (int64_t)slewLength || slewLength > INT64_MAX)
+			return elapsed * rate + anchorFraction;
+
+		return (int64_t)slewLength * rate + (elapsed - (int64_t)slewLength) * settledRate + anchorFraction;
+	}
+
+	uint64_t Apply(uint64_t raw) const
+	{
+		return raw - anchorRaw + anchorTime + (Correction(raw) >> 32);
+	}
+
+	/// @brief Move the anchor, the rate is `newRate` for `length` raw microseconds and `newSettledRate` after that
+	void Reanchor(uint64_t raw, uint64_t time, uint32_t fraction, int32_t newRate, int32_t newSettledRate, uint64_t length)
+	{
+		sequence = sequence + 1;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+
+		anchorRaw      = raw;
+		anchorTime     = time;
+		anchorFraction = fraction;
+		rate           = newRate;
+		settledRate    = newSettledRate;
+		slewLength     = length;
+
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		sequence = sequence + 1;
+	}
+
+	/// @brief Get the first raw counter value at which the disciplined time reaches `time`, must be called with a stable anchor
+	uint64_t Invert(uint64_t time) const
+	{
+		uint64_t raw;
+		uint64_t slewEnd = anchorRaw + slewLength;
+		if (slewLength > INT64_MAX || (int64_t)(time - Apply(slewEnd)) <= 0)
+		{
+			int64_t elapsed = (int64_t)(time - anchorTime);
+			raw             = anchorRaw + elapsed - ((elapsed * rate) >> 32);
+		}
+		else
+		{
+			int64_t elapsed = (int64_t)(time - Apply(slewEnd));
+			raw             = slewEnd + elapsed - ((elapsed * settledRate) >> 32);
+		}
+
+		// The estimate is within a microsecond, settle on the exact inverse
+		while (Apply(raw) < time)
+			raw++;
+		while (raw > 0 && Apply(raw - 1) >= time)
+			raw--;
+
+		return raw;
+	}
+
+  public:
+	/**
+	 * @brief Convert a raw counter value to disciplined time
+	 *
+	 * @param raw The raw counter value in microseconds
+	 * @return `uint64_t` The disciplined time in microseconds
+	 */
+	uint64_t ToDisciplined(uint64_t raw) const
+	{
+		for (;;)
+		{
+			uint32_t start = sequence;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+
+			uint64_t time = Apply(raw);
+
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			if ((start & 1) == 0 && start == sequence)
+				return time;
+		}
+	}
+
+	/**
+	 * @brief Convert disciplined time to the earliest raw counter value at which it is reached
+	 *
+	 * @param time The disciplined time in microseconds
+	 * @return `uint64_t` The raw counter value in microseconds
+	 */
+	uint64_t ToRaw(uint64_t time) const
+	{
+		for (;;)
+		{
+			uint32_t start = sequence;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+
+			uint64_t raw = Invert(time);
+
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			if ((start & 1) == 0 && start == sequence)
+				return raw;
+		}
+	}
+
+	/**
+	 * @brief Add a synchronization sample
+	 * @remark Must not be interrupted by another call, readers may run concurrently
+	 *
+	 * @param raw The raw counter value when the reference event happened
+	 * @param reference The reference time of the event in microseconds
+	 * @return `bool` Whether the sample was used, false if it was rejected as an outlier
+	 */
+	bool AddSample(uint64_t raw, uint64_t reference)
+	{
+		uint64_t local = Apply(raw);
+		int64_t offset = (int64_t)(local - reference);
+		uint64_t size  = offset < 0 ? -offset : offset;
+
+		uint32_t jitterMicroseconds = jitter >> JitterFraction;
+		uint32_t outlierThreshold   = OutlierFactor * jitterMicroseconds > MinOutlierThreshold ? OutlierFactor * jitterMicroseconds : MinOutlierThreshold;
+		if (statistics.Accepted >= SettlingSamples && size > outlierThreshold && size <= (uint64_t)StepThreshold && consecutiveRejects < MaxConsecutiveRejects)
+		{
+			consecutiveRejects++;
+			statistics.Rejected++;
+			return false;
+		}
+
+		consecutiveRejects    = 0;
+		statistics.LastOffset = offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : (int32_t)offset);
+		statistics.Accepted++;
+
+		if (!hasSample || size > (uint64_t)StepThreshold)
+		{
+			// Too far off to slew in a reasonable time, keep the learned frequency and jump to the reference
+			Reanchor(raw, reference, 0, frequency, frequency, UINT64_MAX);
+			statistics.Steps++;
+		}
+		else
+		{
+			int64_t interval = (int64_t)(raw - lastSampleRaw);
+			if (interval > 0)
+			{
+				// The rate that would remove the whole offset over one more interval of the same length
+				int64_t correction = -offset * (1ll << 32) / interval;
+
+				frequency = Clamp(frequency + (correction >> IntegralShift));
+				Reanchor(raw, local, (uint32_t)Correction(raw), Clamp(frequency + (correction >> ProportionalShift)), frequency, interval);
+			}
+
+			uint32_t sizeFixed = size > (UINT32_MAX >> JitterFraction) ? UINT32_MAX : (uint32_t)size << JitterFraction;
+			jitter             = jitter + (int32_t)(sizeFixed - jitter) / (1 << JitterShift);
+		}
+
+		lastSampleRaw = raw;
+		hasSample     = true;
+
+		statistics.SkewPpb = (int32_t)(((int64_t)frequency * 1000000000) >> 32);
+		statistics.Jitter  = jitter >> JitterFraction;
+
+		return true;
+	}
+
+	/**
+	 * @brief Forget all samples and the learned frequency
+	 *
+	 * @param raw The raw counter value that maps to `time`
+	 * @param time The disciplined time to restart from
+	 */
+	void Reset(uint64_t raw = 0, uint64_t time = 0)
+	{
+		Reanchor(raw, time, 0, 0, 0, UINT64_MAX);
+
+		frequency          = 0;
+		lastSampleRaw      = 0;
+		hasSample          = false;
+		consecutiveRejects = 0;
+		jitter             = 0;
+		statistics         = Statistics {};
+	}
+
+	/**
+	 * @brief Get the sync quality counters
+	 *
+	 * @return `Statistics` The current counters
+	 */
+	Statistics GetStatistics() const { return statistics; }
+};
+
+} // namespace PSR
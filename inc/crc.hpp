@@ -0,0 +1,344 @@
+/**
+ * @file crc.hpp
+ * @author Purdue Solar Racing
+ * @brief Table driven CRC-8, CRC-16 and CRC-32 with tables generated at compile time
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#ifdef CRC_HARDWARE
+#include "stm32_includer.h"
+#include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
+#endif
+
+namespace PSR
+{
+
+namespace Detail
+{
+
+template <typename T>
+constexpr T ReverseBits(T value)
+{
+	T output = 0;
+	for (size_t i = 0; i < CHAR_BIT * sizeof(T); i++)
+	{
+		output = (T)((output << 1) | (value & 1));
+		value  = (T)(value >> 1);
+	}
+
+	return output;
+}
+
+/**
+ * @brief The lookup tables of a CRC, table `j` holds the CRC of each byte followed by `j` zero bytes
+ */
+template <typename T, T Polynomial, bool Reflected, size_t Slices>
+struct CrcTable
+{
+	static constexpr size_t Width = CHAR_BIT * sizeof(T);
+
+	T Entries[Slices][256];
+
+	constexpr CrcTable() : Entries {}
+	{
+		for (size_t byte = 0; byte < 256; byte++)
+		{
+			T crc = 0;
+			if (Reflected)
+			{
+				constexpr T reversed = ReverseBits(Polynomial);
+
+				crc = (T)byte;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (T)((crc & 1) ? (crc >> 1) ^ reversed : crc >> 1);
+			}
+			else
+			{
+				crc = (T)((T)byte << (Width - 8));
+				for (int bit = 0; bit < 8; bit++)
+					crc = (T)((crc >> (Width - 1)) ? (T)(crc << 1) ^ Polynomial : (T)(crc << 1));
+			}
+
+			Entries[0][byte] = crc;
+		}
+
+		for (size_t slice = 1; slice < Slices; slice++)
+		{
+			for (size_t byte = 0; byte < 256; byte++)
+			{
+				T previous = Entries[slice - 1][byte];
+				if (Reflected)
+					Entries[slice][byte] = (T)((Width > 8 ? previous >> 8 : 0) ^ Entries[0][previous & 0xFF]);
+				else
+					Entries[slice][byte] = (T)((Width > 8 ? (T)(previous << 8) : 0) ^ Entries[0][(previous >> (Width - 8)) & 0xFF]);
+			}
+		}
+	}
+};
+
+} // namespace Detail
+
+/**
+ * @brief A CRC with the usual Rocksoft model parameters, computed a byte or `Slices` bytes at a time from tables built at compile time
+ * @remark The tables are `constexpr` and end up in flash, `Slices * 256` entries of `T`. Slicing by 4 or 8 trades 4 or 8 times
+ * the table size for about as many fewer dependent steps per byte. Input and output reflection are set together.
+ *
+ * Either compute a whole buffer with `Compute`, or create an instance and `Update` it as data arrives
+ *
+ * @tparam T The CRC type, its width is the CRC width, 8, 16 or 32 bits
+ * @tparam Polynomial The generator polynomial in normal form, without the top bit
+ * @tparam Initial The register value before the first byte, unreflected like the polynomial, reflected CRCs start from its reverse
+ * @tparam FinalXor The value xored into the register to get the result
+ * @tparam Reflected Whether bytes are processed least significant bit first and the result is reflected
+ * @tparam Slices The number of bytes processed per step, 1, 4 or 8
+ */
+template <typename T, T Polynomial, T Initial, T FinalXor, bool Reflected, size_t Slices = 1>
+class Crc
+{
+	static_assert(std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value || std::is_same<T, uint32_t>::value,
+	              "CRCs must be 8, 16 or 32 bits");
+	static_assert(Slices == 1 || Slices == 4 || Slices == 8, "CRCs can be sliced by 1, 4 or 8 bytes");
+
+  public:
+	using ValueType = T;
+
+	static constexpr size_t Width      = CHAR_BIT * sizeof(T);
+	static constexpr T PolynomialValue = Polynomial;
+	static constexpr T InitialValue    = Initial;
+	static constexpr T FinalXorValue   = FinalXor;
+	static constexpr bool IsReflected  = Reflected;
+	/// @brief The value `Process` starts from, `Initial` in the bit order the register is shifted in
+	static constexpr T InitialRegister = Reflected ? Detail::ReverseBits(Initial) : Initial;
+
+  private:
+	static constexpr Detail::CrcTable<T, Polynomial, Reflected, Slices> table {};
+
+	T state;
+
+	/// @brief Process `Count` bytes at once, the bytes of the register are combined with the first bytes of the data
+	template <size_t Count>
+	static constexpr T Step(T crc, const uint8_t* data)
+	{
+		T next = 0;
+		if constexpr (Count * 8 < Width)
+			next = Reflected ? (T)(crc >> (Count * 8)) : (T)(crc << (Count * 8));
+
+#pragma GCC unroll 8
+		for (size_t k = 0; k < Count; k++)
+		{
+			uint8_t byte = data[k];
+			if (k < Width / 8)
+				byte ^= (uint8_t)(Reflected ? crc >> (8 * k) : crc >> (Width - 8 - 8 * k));
+
+			next ^= table.Entries[Count - 1 - k][byte];
+		}
+
+		return next;
+	}
+
+  public:
+	constexpr Crc() : state(InitialRegister) {}
+
+	/**
+	 * @brief Process the register value over more data, the register value excludes the final xor
+	 *
+	 * @param crc The register value, `InitialRegister` before the first byte
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `T` The new register value
+	 */
+	static constexpr T Process(T crc, const uint8_t* data, size_t size)
+	{
+		if constexpr (Slices > 1)
+		{
+			for (; size >= Slices; size -= Slices, data += Slices)
+				crc = Step<Slices>(crc, data);
+		}
+
+		for (; size > 0; size--, data++)
+			crc = Step<1>(crc, data);
+
+		return crc;
+	}
+
+	/**
+	 * @brief Compute the CRC of a buffer
+	 *
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `T` The CRC
+	 */
+	static constexpr T Compute(const uint8_t* data, size_t size) { return Process(InitialRegister, data, size) ^ FinalXor; }
+
+	/**
+	 * @brief Compute the CRC of a buffer a bit at a time without tables, the reference the table driven versions match
+	 *
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `T` The CRC
+	 */
+	static constexpr T ComputeBitwise(const uint8_t* data, size_t size)
+	{
+		T crc = InitialRegister;
+		for (size_t i = 0; i < size; i++)
+		{
+			if (Reflected)
+			{
+				crc ^= data[i];
+				for (int bit = 0; bit < 8; bit++)
+					crc = (T)((crc & 1) ? (crc >> 1) ^ Detail::ReverseBits(Polynomial) : crc >> 1);
+			}
+			else
+			{
+				crc ^= (T)((T)data[i] << (Width - 8));
+				for (int bit = 0; bit < 8; bit++)
+					crc = (T)((crc >> (Width - 1)) ? (T)(crc << 1) ^ Polynomial : (T)(crc << 1));
+			}
+		}
+
+		return crc ^ FinalXor;
+	}
+
+	/// @brief Start a new calculation
+	constexpr void Reset() { state = InitialRegister; }
+
+	/**
+	 * @brief Add data to the calculation
+	 *
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `Crc&` This calculation
+	 */
+	constexpr Crc& Update(const uint8_t* data, size_t size)
+	{
+		state = Process(state, data, size);
+		return *this;
+	}
+
+	/// @brief Get the CRC of the data added so far
+	constexpr T GetValue() const { return state ^ FinalXor; }
+};
+
+/// @brief CRC-8/SMBUS
+template <size_t Slices = 1>
+using Crc8 = Crc<uint8_t, 0x07, 0x00, 0x00, false, Slices>;
+
+/// @brief CRC-16/IBM-3740, also known as CRC-16/CCITT-FALSE
+template <size_t Slices = 1>
+using Crc16Ccitt = Crc<uint16_t, 0x1021, 0xFFFF, 0x0000, false, Slices>;
+
+/// @brief CRC-16/MODBUS
+template <size_t Slices = 1>
+using Crc16Modbus = Crc<uint16_t, 0x8005, 0xFFFF, 0x0000, true, Slices>;
+
+/// @brief CRC-32/ISO-HDLC, the CRC of Ethernet, zlib and PNG
+template <size_t Slices = 1>
+using Crc32 = Crc<uint32_t, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true, Slices>;
+
+/// @brief CRC-32/MPEG-2, the reset configuration of the STM32 CRC unit
+template <size_t Slices = 1>
+using Crc32Mpeg2 = Crc<uint32_t, 0x04C11DB7, 0xFFFFFFFF, 0x00000000, false, Slices>;
+
+/// @brief CRC-32/ISCSI, also known as CRC-32C
+template <size_t Slices = 1>
+using Crc32C = Crc<uint32_t, 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF, true, Slices>;
+
+namespace Detail
+{
+
+/// @brief The input of the check values in the CRC catalogue
+constexpr uint8_t CrcCheckInput[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+/// @brief Whether the table driven and bitwise versions of a CRC both give its catalogue check value
+template <typename Algorithm>
+constexpr bool CrcMatchesCheck(typename Algorithm::ValueType check)
+{
+	return Algorithm::Compute(CrcCheckInput, sizeof(CrcCheckInput)) == check &&
+	       Algorithm::ComputeBitwise(CrcCheckInput, sizeof(CrcCheckInput)) == check;
+}
+
+static_assert(CrcMatchesCheck<Crc8<>>(0xF4), "CRC-8/SMBUS check value");
+static_assert(CrcMatchesCheck<Crc16Ccitt<>>(0x29B1), "CRC-16/IBM-3740 check value");
+static_assert(CrcMatchesCheck<Crc16Modbus<>>(0x4B37), "CRC-16/MODBUS check value");
+static_assert(CrcMatchesCheck<Crc32<>>(0xCBF43926), "CRC-32/ISO-HDLC check value");
+static_assert(CrcMatchesCheck<Crc32<8>>(0xCBF43926), "Sliced CRC-32/ISO-HDLC check value");
+static_assert(CrcMatchesCheck<Crc32Mpeg2<>>(0x0376E6E7), "CRC-32/MPEG-2 check value");
+static_assert(CrcMatchesCheck<Crc32C<>>(0xE3069283), "CRC-32/ISCSI check value");
+// CRC-16/RIELLO is reflected with an initial value that is not its own reverse, so it checks the Rocksoft convention
+static_assert(CrcMatchesCheck<Crc<uint16_t, 0x1021, 0xB2AA, 0x0000, true>>(0x63D0), "CRC-16/RIELLO check value");
+
+} // namespace Detail
+
+#if defined(CRC_HARDWARE) && defined(CRC_CR_POLYSIZE)
+/**
+ * @brief Computes a CRC with the STM32 CRC unit, with the same interface as the `Crc` it is configured from
+ * @remark Needs a CRC unit with a programmable polynomial. There is one unit, so only one calculation can be in progress at a time. The CRC clock must be enabled first. Enabled by defining `CRC_HARDWARE`
+ *
+ * @tparam Algorithm The `Crc` type whose parameters the unit is configured with
+ */
+template <typename Algorithm>
+class HardwareCrc
+{
+  public:
+	using ValueType = typename Algorithm::ValueType;
+
+  private:
+	static constexpr uint32_t PolySize = Algorithm::Width == 32 ? 0 : Algorithm::Width == 16 ? CRC_CR_POLYSIZE_0 : CRC_CR_POLYSIZE_1;
+
+	// The unit works most significant bit first, reflected CRCs reverse each input byte and the output instead,
+	// so the register holds the unreflected value and starts from the unreflected initial value as given
+	static constexpr uint32_t Control = PolySize | (Algorithm::IsReflected ? CRC_CR_REV_IN_0 | CRC_CR_REV_OUT : 0);
+
+  public:
+	/// @brief Configure the unit and start a calculation
+	HardwareCrc() { Reset(); }
+
+	/// @brief Configure the unit and start a new calculation
+	void Reset()
+	{
+		CRC->POL  = Algorithm::PolynomialValue;
+		CRC->INIT = Algorithm::InitialValue;
+		CRC->CR   = Control | CRC_CR_RESET;
+	}
+
+	/**
+	 * @brief Add data to the calculation
+	 *
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `HardwareCrc&` This calculation
+	 */
+	HardwareCrc& Update(const uint8_t* data, size_t size)
+	{
+		// Byte writes feed the unit 8 bits at a time, so the data needs no alignment or padding
+		volatile uint8_t* dataRegister = (volatile uint8_t*)&CRC->DR;
+		for (size_t i = 0; i < size; i++)
+			*dataRegister = data[i];
+
+		return *this;
+	}
+
+	/// @brief Get the CRC of the data added so far
+	ValueType GetValue() const { return (ValueType)CRC->DR ^ Algorithm::FinalXorValue; }
+
+	/**
+	 * @brief Compute the CRC of a buffer
+	 *
+	 * @param data The data
+	 * @param size The number of bytes
+	 * @return `ValueType` The CRC
+	 */
+	static ValueType Compute(const uint8_t* data, size_t size) { return HardwareCrc().Update(data, size).GetValue(); }
+};
+#endif
+
+} // namespace PSR
@@ -0,0 +1,71 @@
+/**
+ * @file cycle_counter.hpp
+ * @author Purdue Solar Racing
+ * @brief Access to the DWT cycle counter for timestamping and profiling
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "stm32_includer.h"
+#include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
+#include STM32_INCLUDE(STM32_PROCESSOR, hal_def.h)
+#include STM32_INCLUDE(STM32_PROCESSOR, hal_rcc.h)
+
+#include <cstdint>
+
+// Cortex-M0 and M0+ have no DWT, and the Cortex-M23 DWT has no cycle counter. Defining `CYCLE_COUNTER_DISABLED`
+// keeps the modules that can do without it off the DWT, for example when a debugger owns it
+#if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk) && !defined(CYCLE_COUNTER_DISABLED)
+#define CYCLE_COUNTER_AVAILABLE
+#endif
+
+namespace PSR
+{
+
+#ifdef CYCLE_COUNTER_AVAILABLE
+/**
+ * @brief The free running core clock cycle counter of the DWT unit
+ * @remark Only available on Cortex-M3 and above, where `CYCLE_COUNTER_AVAILABLE` is defined. The counter wraps every `2^32` cycles,
+ * so differences between two readings are correct as long as they are less than one wrap apart
+ */
+class CycleCounter
+{
+  public:
+	/**
+	 * @brief Enable the cycle counter
+	 * @remark Does not reset the counter if it is already running, so it is safe to call from several modules
+	 */
+	static void Init()
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+		{
+			DWT->CYCCNT = 0;
+			DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+		}
+	}
+
+	/**
+	 * @brief Get the current cycle count
+	 *
+	 * @return `uint32_t` The number of core clock cycles since the counter was enabled, modulo `2^32`
+	 */
+	static uint32_t GetCount() { return DWT->CYCCNT; }
+
+	/**
+	 * @brief Convert a number of cycles to microseconds
+	 *
+	 * @param cycles The number of core clock cycles
+	 * @return `uint32_t` The number of microseconds
+	 */
+	static uint32_t ToMicroseconds(uint32_t cycles)
+	{
+		return (uint32_t)((uint64_t)cycles * 1000000 / HAL_RCC_GetHCLKFreq());
+	}
+};
+#endif
+
+} // namespace PSR
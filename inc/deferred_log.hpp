@@ -0,0 +1,221 @@
+/**
+ * @file deferred_log.hpp
+ * @author Purdue Solar Racing
+ * @brief Binary logging that defers formatting to a host side decoder
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "cycle_counter.hpp"
+#include "inplace_function.hpp"
+
+#include "stm32_includer.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Log a message without formatting it
+ * @remark The format string is placed in the `.log_strings` section and only its address is stored, so it must be a string literal.
+ * Add `.log_strings (INFO) : { KEEP(*(.log_strings)) }` to the linker script to keep the strings out of flash,
+ * `tools/decode_log.py` reads them back from the ELF file
+ *
+ * @param format The printf format string literal
+ */
+#define DEFERRED_LOG(format, ...)                                                                             \
+	do                                                                                                        \
+	{                                                                                                         \
+		static const char CAT(logFormat, __LINE__)[] __attribute__((section(".log_strings"), used)) = format; \
+		::PSR::DeferredLog::Write(CAT(logFormat, __LINE__), ##__VA_ARGS__);                                   \
+	} while (0)
+
+namespace PSR
+{
+
+/**
+ * @brief Lock-free ring of binary log records
+ *
+ * @remark A record stores the address of its format string, a cycle counter timestamp and the raw bytes of its arguments,
+ * which takes well under a microsecond instead of formatting text. Any context, including nested interrupts, can write:
+ * space is claimed with a compare-and-swap on the head and the record is published by storing its header word last.
+ * On ARMv6-M, which has no exclusive accesses, the compare-and-swap masks interrupts for a few instructions instead.
+ * A single background task calls `Drain` to send finished records to a sink, by default `stdout`.
+ *
+ * Each record is a run of little endian 32-bit words:
+ * - The header, `Magic | length` where length is the number of words in the record
+ * - The format string address
+ * - The cycle counter timestamp, or the `HAL_GetTick` milliseconds on cores without a cycle counter
+ * - The argument types, four bits per argument starting at the low bits, one of `ArgumentType`
+ * - The arguments, 32-bit values take one word, 64-bit values and doubles two words, low word first,
+ *   and strings a byte length word followed by the bytes padded to a whole word
+ */
+class DeferredLog
+{
+  public:
+	/// @brief The ring size in words, must be a power of two
+	static constexpr size_t CapacityWords = 1024;
+	/// @brief The maximum number of arguments in one record
+	static constexpr size_t MaxArguments = 8;
+	/// @brief Longer string arguments are truncated
+	static constexpr size_t MaxStringLength = 32;
+
+	/// @brief Marks a published record header, the low bits hold the record length in words
+	static constexpr uint32_t Magic       = 0x4C470000;
+	static constexpr uint32_t MagicMask   = 0xFFFF0000;
+	static constexpr uint32_t HeaderWords = 4;
+
+	enum ArgumentType : uint32_t
+	{
+		Int32  = 1,
+		Int64  = 2,
+		Double = 3,
+		String = 4,
+	};
+
+	/// @brief Called with each drained record
+	using Sink = InplaceFunction<void(const uint8_t* data, size_t size)>;
+
+  private:
+	static_assert((CapacityWords & (CapacityWords - 1)) == 0, "CapacityWords must be a power of two");
+
+	static constexpr size_t StringWords    = 1 + (MaxStringLength + 3) / 4;
+	static constexpr size_t MaxRecordWords = HeaderWords + MaxArguments * StringWords;
+
+	static std::array<std::atomic<uint32_t>, CapacityWords> ring;
+	/// @brief The next word to be claimed by a writer
+	static std::atomic<uint32_t> head;
+	/// @brief The next word to be drained
+	static std::atomic<uint32_t> tail;
+	static std::atomic<uint32_t> dropped;
+	static Sink sink;
+
+	/// @brief Claim space for a record and publish it
+	static bool Commit(uint32_t* record, size_t length);
+
+	template <typename T>
+	static void Append(uint32_t* record, size_t& length, uint32_t& types, size_t& index, T value)
+	{
+		using D = typename std::decay<T>::type;
+
+		uint32_t type;
+		if constexpr (std::is_same<D, const char*>::value || std::is_same<D, char*>::value)
+		{
+			size_t size = value == nullptr ? 0 : strnlen(value, MaxStringLength);
+
+			type             = String;
+			record[length++] = size;
+			if (size > 0)
+			{
+				record[length + (size - 1) / 4] = 0; // Zero the padding
+				memcpy(&record[length], value, size);
+			}
+			length += (size + 3) / 4;
+		}
+		else if constexpr (std::is_floating_point<D>::value)
+		{
+			double number = value;
+			uint64_t bits;
+			memcpy(&bits, &number, sizeof(bits));
+
+			type             = Double;
+			record[length++] = (uint32_t)bits;
+			record[length++] = (uint32_t)(bits >> 32);
+		}
+		else
+		{
+			static_assert(std::is_integral<D>::value || std::is_enum<D>::value || std::is_pointer<D>::value, "Unsupported log argument type");
+
+			uint64_t bits;
+			if constexpr (std::is_pointer<D>::value)
+				bits = (uintptr_t)value;
+			else
+				bits = (uint64_t)value;
+
+			if (sizeof(D) > sizeof(uint32_t))
+			{
+				type             = Int64;
+				record[length++] = (uint32_t)bits;
+				record[length++] = (uint32_t)(bits >> 32);
+			}
+			else
+			{
+				type             = Int32;
+				record[length++] = (uint32_t)bits;
+			}
+		}
+
+		types |= type << (4 * index++);
+	}
+
+  public:
+	/**
+	 * @brief Write a record, use `DEFERRED_LOG` so the format string is placed in the right section
+	 * @remark Safe to call from any context, the record is dropped if the ring is full
+	 *
+	 * @param format The format string
+	 * @param args The arguments
+	 * @return `bool` Whether the record was written
+	 */
+	template <typename... Args>
+	static bool Write(const char* format, Args... args)
+	{
+		static_assert(sizeof...(Args) <= MaxArguments, "Too many log arguments");
+
+		uint32_t record[MaxRecordWords];
+		size_t length                 = HeaderWords;
+		uint32_t types                = 0;
+		[[maybe_unused]] size_t index = 0;
+		(Append(record, length, types, index, args), ...);
+
+		record[1] = (uint32_t)(uintptr_t)format;
+#ifdef CYCLE_COUNTER_AVAILABLE
+		record[2] = CycleCounter::GetCount();
+#else
+		record[2] = HAL_GetTick();
+#endif
+		record[3] = types;
+
+		return Commit(record, length);
+	}
+
+	/**
+	 * @brief Start the cycle counter used for timestamps
+	 */
+	static void Init()
+	{
+#ifdef CYCLE_COUNTER_AVAILABLE
+		CycleCounter::Init();
+#endif
+	}
+
+	/**
+	 * @brief Set where drained records are sent
+	 *
+	 * @param sink Called with the bytes of each record, `nullptr` to write them to `stdout`
+	 */
+	static void SetSink(const Sink& sink);
+
+	/**
+	 * @brief Send finished records to the sink
+	 * @remark Must only be called from one context, usually a low rate scheduler task.
+	 * Stops at a record that is still being written
+	 *
+	 * @param maxRecords The maximum number of records to send
+	 * @return `size_t` The number of records sent
+	 */
+	static size_t Drain(size_t maxRecords = SIZE_MAX);
+
+	/**
+	 * @brief Get the number of records dropped because the ring was full
+	 */
+	static uint32_t GetDropped() { return dropped.load(std::memory_order_relaxed); }
+};
+
+} // namespace PSR
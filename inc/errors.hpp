@@ -9,45 +9,51 @@
  */
 #pragma once
 
-#include <cstring>
-#include <memory>
+#include "status.hpp"
+
+#include <cstddef>
 
 namespace PSR
 {
 
 /// @brief Contains logic for creating and displaying nested error messages
+/// @remark Messages are kept in a fixed pool and rendered into a static buffer, so reporting an error never allocates.
+/// Every call is safe from interrupts
 class ErrorMessage
 {
   public:
+	/// @brief The maximum number of nested messages, further wraps drop the messages just outside the innermost one
+	static constexpr size_t MaxErrors = 8;
+	/// @brief The maximum length of a formatted message including the null terminator, longer messages are truncated
+	static constexpr size_t MaxMessageLength = 64;
+	/// @brief The size of the buffer returned by `GetMessage`
+	static constexpr size_t RenderBufferSize = MaxErrors * (MaxErrors + MaxMessageLength) + 32;
+
 	/// @brief Structure for a single nested error message
 	struct Error
 	{
-		std::shared_ptr<char[]> Message;
-		std::shared_ptr<Error> InnerError;
-
-		static constexpr const char* EmptyError = "";
-
-		static void EmptyDeleter(char* message) {}
-
-		Error(const char* message, const std::shared_ptr<Error>& innerError)
-			: Message((char*)message, EmptyDeleter), InnerError(innerError)
-		{ }
-
-		Error(const std::shared_ptr<char[]> message, const std::shared_ptr<Error>& innerError)
-			: Message(message), InnerError(innerError) {}
-
-		Error(const char* message)
-			: Error(message, nullptr) {}
-
-		Error(const std::shared_ptr<char[]> message)
-			: Error(message, nullptr) {}
+		/// @brief A message with static storage, or `nullptr` if the message is a code or was formatted into `Text`
+		const char* Static;
+		/// @brief An error code that is only turned into text when the message is rendered
+		ErrorCode Code;
+		char Text[MaxMessageLength];
 	};
 
+	static constexpr const char* EmptyError = "";
+
   private:
-	static std::shared_ptr<Error> error;
+	/// @brief The nested messages from the innermost at index 0 to the outermost
+	static Error errors[MaxErrors];
+	static size_t depth;
+	/// @brief Messages were dropped between the innermost and the next one
+	static bool truncated;
+	static char renderBuffer[RenderBufferSize];
+
+	/// @brief Get the entry for a new outermost message, must be called with interrupts disabled
+	static Error& Push();
 
-	static size_t GetRequiredMessageSize(const std::shared_ptr<Error>& error, size_t depth = 0);
-	static std::shared_ptr<char[]> WriteInnerErrors(const std::shared_ptr<Error>& error);
+	/// @brief Clear the messages and add a new innermost message, must be called with interrupts disabled
+	static Error& Reset();
 
   public:
 	/**
@@ -59,19 +65,31 @@ class ErrorMessage
 
 	/**
 	 * @brief Get the current error message
-	 * @return const char* The current error message
+	 * @remark The outermost message is on the first line, each inner message is indented by one more tab
+	 * @return const char* The current error message, valid until the next call
 	 */
-	static const char* GetMessage()
-	{
-		if (error == nullptr)
-			return Error::EmptyError; // Return empty error message
+	static const char* GetMessage();
+
+	/**
+	 * @brief Write the current error message into a buffer
+	 * @remark Use instead of `GetMessage` when another context may get the message at the same time.
+	 * Interrupts are only disabled to copy the messages, they are rendered afterwards
+	 *
+	 * @param buffer The buffer to write to, always null terminated
+	 * @param size The size of the buffer
+	 * @return `size_t` The length of the message, truncated to fit the buffer
+	 */
+	static size_t WriteMessage(char* buffer, size_t size);
 
-		std::shared_ptr<char[]> message = WriteInnerErrors(error);
-		if (message == nullptr)
-			return Error::EmptyError; // Return empty error message
-		
-		return message.get();
-	}
+	/**
+	 * @brief Write the chain of a status as nested text, in the same format as the current error message
+	 *
+	 * @param status The status to write
+	 * @param buffer The buffer to write to, always null terminated
+	 * @param size The size of the buffer
+	 * @return `size_t` The length of the message, truncated to fit the buffer
+	 */
+	static size_t WriteMessage(const Status& status, char* buffer, size_t size);
 
 	/**
 	 * @brief Print the current error messages to the serial port, will clear all messages after printing
@@ -80,31 +98,31 @@ class ErrorMessage
 
 	/// @brief Set the current error message
 	/// @param message A message to set the error. @remark DO NOT POINT TO A STACK ALLOCATED BUFFER.
-	static void SetMessage(const char* message)
-	{
-		error = std::shared_ptr<Error>(new Error(message));
-	}
-	
-	/// @brief Set the current error message
-	/// @param message A message to set the error.
-	static void SetMessage(const std::shared_ptr<char[]>& message)
-	{
-		error = std::shared_ptr<Error>(new Error(message));
-	}
+	static void SetMessage(const char* message);
+
+	/// @brief Set the current error message to an error code, which is only described when the message is rendered
+	/// @param code The error code
+	static void SetMessage(ErrorCode code);
+
+	/// @brief Set the current error messages to the chain of a status
+	/// @param status The status, clears the messages on success
+	static void SetMessage(const Status& status);
+
+	/// @brief Set the current error message to a formatted message, which is copied
+	/// @param format The printf format string
+	static void SetFormattedMessage(const char* format, ...) __attribute__((format(printf, 1, 2)));
 
 	/// @brief Wrap the current error message with a new message
 	/// @param message A message to wrap the inner error with. @remark DO NOT POINT TO A STACK ALLOCATED BUFFER.
-	static void WrapMessage(const char* message)
-	{
-		error = std::shared_ptr<Error>(new Error(message, error));
-	}
+	static void WrapMessage(const char* message);
 
-	/// @brief Wrap the current error message with a new message
-	/// @param message A message to wrap the inner error with.
-	static void WrapMessage(const std::shared_ptr<char[]>& message)
-	{
-		error = std::shared_ptr<Error>(new Error(message, error));
-	}
+	/// @brief Wrap the current error message with an error code, which is only described when the message is rendered
+	/// @param code The error code
+	static void WrapMessage(ErrorCode code);
+
+	/// @brief Wrap the current error message with a formatted message, which is copied
+	/// @param format The printf format string
+	static void WrapFormattedMessage(const char* format, ...) __attribute__((format(printf, 1, 2)));
 };
 
-} // namespace PSR
\ No newline at end of file
+} // namespace PSR
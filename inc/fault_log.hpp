@@ -0,0 +1,127 @@
+/**
+ * @file fault_log.hpp
+ * @author Purdue Solar Racing
+ * @brief Ring of timestamped error records that survives warm resets
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "high_precision_counter.hpp"
+#include "status.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PSR
+{
+
+/**
+ * @brief Post-mortem history of error codes kept in RAM that is not cleared on reset
+ *
+ * @remark The ring is placed in the `.noinit` section, which the linker script must mark `NOLOAD` and the startup code must not clear:
+ * `.noinit (NOLOAD) : { *(.noinit) } > RAM`. After a watchdog or software reset the records of the previous boots are still there,
+ * after a power cycle the contents are invalid and the ring starts empty.
+ *
+ * Recording is O(1) and safe from any context. A code that repeats within `CoalesceWindow` of its last occurrence
+ * increments the count of the newest record instead of taking a new one, so a burst of the same fault does not flush the history.
+ */
+class FaultLog
+{
+  public:
+	/// @brief The number of records kept, must be a power of two
+	static constexpr size_t Capacity = 32;
+	/// @brief Repeats of the newest code within this many microseconds are merged into its record
+	static constexpr uint64_t CoalesceWindow = 1000000;
+
+	/// @brief One error code and how often it happened in a burst
+	struct Entry
+	{
+		uint32_t Code;      ///< @brief The raw `ErrorCode` value
+		uint16_t Count;     ///< @brief The number of occurrences, saturates
+		uint16_t Boot;      ///< @brief The boot the record was made in, see `GetBootCount`
+		uint64_t FirstTime; ///< @brief The counter time of the first occurrence in microseconds
+		uint64_t LastTime;  ///< @brief The counter time of the last occurrence in microseconds
+		uint32_t Check;     ///< @brief Detects records that were never written or were corrupted
+	};
+
+  private:
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	static constexpr uint32_t Magic = 0x464C5431;
+
+	struct Storage
+	{
+		uint32_t Magic;
+		/// @brief The number of records ever made, the next one goes at `Head % Capacity`
+		uint32_t Head;
+		uint16_t Boot;
+		Entry Entries[Capacity];
+	};
+
+	static Storage storage;
+	static const HighPrecisionCounter* counter;
+
+	static uint32_t Checksum(const Entry& entry);
+	/// @brief Start over if the storage does not hold a log, must be called with interrupts disabled
+	static void Validate();
+
+  public:
+	/**
+	 * @brief Keep the records of previous boots if they are intact and start a new boot
+	 * @remark Call once early during startup. Records made before this are kept but have no timestamp
+	 *
+	 * @param counter The time source for timestamps, or `nullptr` for none
+	 */
+	static void Init(const HighPrecisionCounter* counter);
+
+	/**
+	 * @brief Record an error
+	 *
+	 * @param code The error code, `Errors::None` is ignored
+	 */
+	static void Record(ErrorCode code);
+
+	/**
+	 * @brief Record the root cause of a failed status
+	 *
+	 * @param status The status, ignored on success
+	 */
+	static void Record(const Status& status) { Record(status.GetRootCause()); }
+
+	/**
+	 * @brief Copy records out for telemetry, oldest first
+	 * @remark Keep `sequence` between calls to read only new records. Records that were overwritten are skipped,
+	 * and the newest record can still gain repeats after it has been read
+	 *
+	 * @param sequence The sequence number of the first record to read, updated to the one after the last record read
+	 * @param entries The buffer to copy the records to
+	 * @param maxEntries The size of the buffer
+	 * @return `size_t` The number of records copied
+	 */
+	static size_t Read(uint32_t& sequence, Entry* entries, size_t maxEntries);
+
+	/**
+	 * @brief Get the sequence number of the next record, the number of records ever made since the log was cleared
+	 */
+	static uint32_t GetSequence() { return storage.Head; }
+
+	/**
+	 * @brief Get the sequence number of the oldest record that is still kept
+	 */
+	static uint32_t GetOldestSequence() { return storage.Head > Capacity ? storage.Head - Capacity : 0; }
+
+	/**
+	 * @brief Get the number of times `Init` was called since the log was cleared, including this boot
+	 */
+	static uint16_t GetBootCount() { return storage.Boot; }
+
+	/**
+	 * @brief Forget every record and the boot count
+	 */
+	static void Clear();
+};
+
+} // namespace PSR
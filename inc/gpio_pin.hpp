@@ -31,7 +31,7 @@ class GpioPin
 		: port(nullptr), pin(0)
 	{}
 
-	constexpr GpioPin(nullptr_t ptr) : GpioPin() {}
+	constexpr GpioPin(nullptr_t) : GpioPin() {}
 
 	constexpr GpioPin(GPIO_TypeDef* port, uint32_t pin)
 		: port(port), pin(pin)
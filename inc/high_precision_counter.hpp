@@ -1,5 +1,9 @@
 #pragma once
 
+#include "clock_discipline.hpp"
+#include "inplace_function.hpp"
+#include "timer_registers.hpp"
+
 #include "stm32_includer.h"
 #include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
 #include STM32_INCLUDE(STM32_PROCESSOR, hal_def.h)
@@ -8,7 +12,6 @@
 
 #include <array>
 #include <cstdint>
-#include <functional>
 
 namespace PSR
 {
@@ -17,31 +20,73 @@ class HighPrecisionCounter
 {
   private:
 	TIM_TypeDef* const tim;
+	/// @brief The slave timer counting overflows of `tim` in cascaded mode, `nullptr` otherwise
+	TIM_TypeDef* const upperTim;
+	/// @brief The `TIM_TS_ITRx` input connecting `tim` to `upperTim` in cascaded mode
+	const uint32_t triggerSelection;
 	const uint32_t timerPrecision;
-	uint64_t upperCount   = 0;
-	uint64_t lastSyncTime = 0; ///< @brief the last time the counter was synced with an external source
+	/// @brief The microseconds counted by previous timer periods, unused in cascaded mode
+	/// @remark Only written with interrupts disabled so that readers never see half of an update
+	volatile uint64_t upperCount = 0;
+	uint64_t lastSyncTime        = 0; ///< @brief the last time the counter was synced with an external source
+	/// @brief Converts the raw hardware count to time synchronized with the external source
+	ClockDiscipline discipline;
 
 	struct DelayedCallback
 	{
+		/// @brief The time at which the callback is due, in microseconds
 		uint64_t DelayUntil;
-		std::function<void()> Callback;
+		/// @brief The period of a repeating callback in microseconds, zero for a one-shot callback
+		uint64_t Period;
+		InplaceFunction<void()> Callback;
+		/// @brief Incremented every time the slot is freed so stale handles can be detected
+		uint16_t Generation;
+		/// @brief The position of this callback in the heap
+		uint8_t HeapIndex;
 
 		DelayedCallback()
-			: DelayUntil(0), Callback(nullptr)
+			: DelayUntil(0), Period(0), Callback(nullptr), Generation(0), HeapIndex(0)
 		{}
 	};
 
 	static constexpr size_t MaxCallbacks = 32;
 	std::array<DelayedCallback, MaxCallbacks> delayedCallbacks;
 
-	/// @brief The highest index of a delayed callback
-	size_t highestCallbackIndex = 0;
+	/// @brief Binary min-heap of indices into `delayedCallbacks`, ordered by `DelayUntil`
+	/// @remark The earliest callback is always at the top, so the interrupt only has to look at `callbackHeap[0]`
+	std::array<uint8_t, MaxCallbacks> callbackHeap;
+	/// @brief The number of callbacks in the heap
+	size_t callbackCount = 0;
 
 	bool isInitialized = false;
 
 	void HandleDelayCallbacks();
+	void ArmAlarm();
 	void ClearCallbacks();
 
+	/// @brief Get the number of microseconds before the lower counter rolls over, a precision of zero uses the full 32-bit range
+	uint64_t GetPeriod() const { return timerPrecision == 0 ? (1ull << 32) : timerPrecision; }
+
+	uint64_t GetCascadedCount() const
+	{
+		uint32_t high = upperTim->CNT;
+		for (;;)
+		{
+			uint32_t low       = tim->CNT;
+			uint32_t highAfter = upperTim->CNT;
+
+			// The lower timer did not overflow between the reads
+			if (high == highAfter)
+				return ((uint64_t)high << 32) | low;
+
+			high = highAfter;
+		}
+	}
+
+	void HeapSiftUp(size_t position);
+	void HeapSiftDown(size_t position);
+	void HeapRemove(size_t position);
+
   public:
 	static constexpr uint32_t MillesecondsToMicroseconds = 1000;
 
@@ -52,7 +97,21 @@ class HighPrecisionCounter
 	 * @param timerPrecision The number of microseconds before the counter rolls over
 	 */
 	HighPrecisionCounter(TIM_TypeDef* const tim, uint32_t timerPrecision)
-		: tim(tim), timerPrecision(timerPrecision), delayedCallbacks()
+		: tim(tim), upperTim(nullptr), triggerSelection(0), timerPrecision(timerPrecision), delayedCallbacks()
+	{}
+
+	/**
+	 * @brief Construct a new High Precision Counter object from two chained 32-bit timers
+	 *
+	 * @remark The lower timer counts microseconds and its update event clocks the upper timer through an internal trigger,
+	 * so the 64-bit count is kept entirely in hardware. The update interrupt is only used to arm callbacks
+	 *
+	 * @param lowerTim The 32-bit master timer counting microseconds
+	 * @param upperTim The 32-bit slave timer counting overflows of the master
+	 * @param triggerSelection The `TIM_TS_ITRx` input of the slave that is connected to the master's TRGO
+	 */
+	HighPrecisionCounter(TIM_TypeDef* const lowerTim, TIM_TypeDef* const upperTim, uint32_t triggerSelection)
+		: tim(lowerTim), upperTim(upperTim), triggerSelection(triggerSelection), timerPrecision(0), delayedCallbacks()
 	{}
 
 	/**
@@ -66,18 +125,56 @@ class HighPrecisionCounter
 	 * @brief Update the counter
 	 * @param statusRegister The timer status register when the interrupt was triggered
 	 * @param suppressCallbacks Whether to suppress the delayed callbacks
-	 * @remark This function should be called in the timer interrupt
+	 * @remark This function should be called in the timer interrupt, for both the update and capture/compare 1 events.
+	 * Channel 1 is programmed to interrupt exactly when the earliest delayed callback is due, so the timer must not use it for anything else.
+	 * Call this before clearing the timer flags, it clears the flags it handles itself
 	 */
 	void Update(uint32_t statusRegister, bool suppressCallbacks = false) __attribute__((section(".RamFunc")));
 
 	/**
 	 * @brief Get the current count of the timer
 	 *
+	 * @remark Lock-free and monotonic while the counter is slewing, see `Synchronize`
+	 *
 	 * @return `uint64_t` The current count in microseconds
 	 */
 	uint64_t GetCount() const
 	{
-		return this->upperCount + this->tim->CNT;
+		return discipline.ToDisciplined(GetRawCount());
+	}
+
+	/**
+	 * @brief Get the count of the hardware timer, without synchronization to an external source
+	 *
+	 * @remark Lock-free and monotonic. An overflow that the update interrupt has not handled yet is detected through `UIF`,
+	 * and the read is retried if the interrupt runs or the timer overflows part way through
+	 *
+	 * @return `uint64_t` The raw count in microseconds
+	 */
+	uint64_t GetRawCount() const
+	{
+		if (this->upperTim != nullptr)
+			return GetCascadedCount();
+
+		for (;;)
+		{
+			uint64_t upper  = this->upperCount;
+			bool overflowed = Tim::SR::UIF::Read(this->tim) != 0;
+			uint32_t count  = this->tim->CNT;
+
+			// Overflowed between reading the status and the counter, so the counter may be from either period
+			if (!overflowed && Tim::SR::UIF::Read(this->tim) != 0)
+				continue;
+
+			// The update interrupt ran during the read
+			if (upper != this->upperCount)
+				continue;
+
+			if (overflowed)
+				upper += GetPeriod(); // Overflowed before the counter was read, but the interrupt has not run yet
+
+			return upper + count;
+		}
 	}
 
 	/// @brief Get the current time in microseconds since the timer started
@@ -108,7 +205,7 @@ class HighPrecisionCounter
 	/**
 	 * @brief Get the number of microseconds before the lower counter rolls over
 	 * 
-	 * @return uint32_t The timer precision in microseconds
+	 * @return uint32_t The timer precision in microseconds, zero for the full 32-bit range
 	 */
 	uint32_t GetPrecision() const
 	{
@@ -143,6 +240,9 @@ class HighPrecisionCounter
 		upperCount   = 0;
 		lastSyncTime = 0;
 		tim->CNT     = 0;
+		if (upperTim != nullptr)
+			upperTim->CNT = 0;
+		discipline.Reset();
 
 		ClearCallbacks();
 	}
@@ -165,6 +265,18 @@ class HighPrecisionCounter
 		}
 	}
 
+	/// @brief Identifies a delayed callback so that it can be cancelled
+	struct CallbackHandle
+	{
+		static constexpr uint16_t InvalidIndex = 0xFFFF;
+
+		uint16_t Index      = InvalidIndex;
+		uint16_t Generation = 0;
+
+		/// @brief Get whether the handle refers to a callback that was added
+		bool IsValid() const { return Index != InvalidIndex; }
+	};
+
 	/**
 	 * @brief Add a callback to be called after a delay
 	 *
@@ -174,19 +286,94 @@ class HighPrecisionCounter
 	 * @param callback The callback to execute
 	 * @return `bool` Whether the callback was added
 	 */
-	bool AddDelayedCallback(uint32_t delay, const std::function<void()>& callback);
+	bool AddDelayedCallback(uint32_t delay, const InplaceFunction<void()>& callback)
+	{
+		if (delay == 0)
+			return false;
+
+		return AddDelayedCallbackMicroseconds((uint64_t)delay * MillesecondsToMicroseconds, callback).IsValid();
+	}
+
+	/**
+	 * @brief Add a callback to be called after a delay
+	 *
+	 * @remark The callback will be called in a non-interrupt context, after all other interrupts have been handled
+	 *
+	 * @param delay The delay in microseconds
+	 * @param callback The callback to execute
+	 * @return `CallbackHandle` A handle that can be used to cancel the callback, invalid if it could not be added
+	 */
+	CallbackHandle AddDelayedCallbackMicroseconds(uint64_t delay, const InplaceFunction<void()>& callback)
+	{
+		return AddCallbackAt(GetCount() + delay, callback);
+	}
+
+	/**
+	 * @brief Add a callback to be called at an absolute time
+	 *
+	 * @remark A time that has already passed is called on the next update
+	 *
+	 * @param time The counter value in microseconds at which to call the callback
+	 * @param callback The callback to execute
+	 * @param period The interval in microseconds at which to repeat the callback, zero for a one-shot callback
+	 * @return `CallbackHandle` A handle that can be used to cancel the callback, invalid if it could not be added
+	 */
+	CallbackHandle AddCallbackAt(uint64_t time, const InplaceFunction<void()>& callback, uint64_t period = 0);
 
-	/// @brief Synchronize the counter with an external source
-	/// @param exectedDelay The expected delay from the previous call to this function
+	/**
+	 * @brief Add a callback to be called repeatedly
+	 *
+	 * @remark Repeats are scheduled from the previous due time so they do not drift, missed repeats are skipped
+	 *
+	 * @param period The interval in microseconds at which to call the callback
+	 * @param callback The callback to execute
+	 * @return `CallbackHandle` A handle that can be used to cancel the callback, invalid if it could not be added
+	 */
+	CallbackHandle AddPeriodicCallback(uint64_t period, const InplaceFunction<void()>& callback)
+	{
+		if (period == 0)
+			return CallbackHandle();
+
+		return AddCallbackAt(GetCount() + period, callback, period);
+	}
+
+	/**
+	 * @brief Cancel a callback before it is called
+	 *
+	 * @param handle The handle returned when the callback was added
+	 * @return `bool` Whether the callback was cancelled, false if it already ran or the handle is invalid
+	 */
+	bool CancelCallback(CallbackHandle handle);
+
+	/**
+	 * @brief Synchronize the counter with an external source
+	 *
+	 * @remark Successive calls learn the frequency error of the timer's clock and slew the count smoothly towards the source,
+	 * only offsets larger than `ClockDiscipline::StepThreshold` make the count jump. Call this as close to the reference event as possible
+	 *
+	 * @param exectedDelay The expected delay from the previous call to this function
+	 */
 	void Synchronize(uint32_t exectedDelay)
 	{
-		uint64_t currentTime = GetCount();
-		uint64_t expectedTime = lastSyncTime + exectedDelay;
+		SynchronizeTo(lastSyncTime + exectedDelay);
+	}
 
-		int64_t delta = expectedTime - currentTime;
+	/**
+	 * @brief Synchronize the counter with an external source that provides absolute time, such as another node's timestamp
+	 *
+	 * @param referenceTime The time of the reference event according to the external source, in microseconds
+	 * @return `bool` Whether the sample was used, false if it was rejected as an outlier
+	 */
+	bool SynchronizeTo(uint64_t referenceTime);
 
-		upperCount += delta;
-		lastSyncTime = GetCount();
+	/**
+	 * @brief Get the offset, skew and jitter of the synchronization with the external source
+	 *
+	 * @return `ClockDiscipline::Statistics` The sync quality counters
+	 */
+	ClockDiscipline::Statistics GetSyncStatistics() const
+	{
+		return discipline.GetStatistics();
 	}
 };
 
@@ -0,0 +1,111 @@
+/**
+ * @file inplace_function.hpp
+ * @author Purdue Solar Racing
+ * @brief Fixed capacity callable wrapper that never allocates
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace PSR
+{
+
+/// @brief The default number of bytes of captured state an `InplaceFunction` can hold
+static constexpr size_t InplaceFunctionDefaultCapacity = 2 * sizeof(void*);
+
+template <typename Signature, size_t Capacity = InplaceFunctionDefaultCapacity>
+class InplaceFunction;
+
+/**
+ * @brief Callable wrapper with a fixed inline capacity, a replacement for `std::function` that is safe to copy in interrupts
+ *
+ * @remark The callable is stored inside the object itself and must be trivially copyable and trivially destructible,
+ * so copying an `InplaceFunction` is a plain copy of its bytes and never calls `malloc` or a destructor.
+ * A callable that is too large or not trivially copyable is rejected at compile time.
+ *
+ * @tparam R The return type of the callable
+ * @tparam Args The argument types of the callable
+ * @tparam Capacity The number of bytes of captured state that can be stored
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+  public:
+	static constexpr size_t Alignment = alignof(std::max_align_t);
+
+  private:
+	using Invoker = R (*)(void* storage, Args... args);
+
+	alignas(Alignment) mutable unsigned char storage[Capacity];
+	Invoker invoker = nullptr;
+
+	template <typename F>
+	static R Invoke(void* storage, Args... args)
+	{
+		return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+	}
+
+  public:
+	constexpr InplaceFunction()
+		: storage()
+	{}
+
+	constexpr InplaceFunction(std::nullptr_t)
+		: InplaceFunction()
+	{}
+
+	/**
+	 * @brief Construct a new Inplace Function object from a callable
+	 *
+	 * @tparam F The type of the callable
+	 * @param function The callable to store
+	 */
+	template <typename F,
+			  typename D = typename std::decay<F>::type,
+			  typename   = typename std::enable_if<!std::is_same<D, InplaceFunction>::value && std::is_invocable_r<R, D&, Args...>::value>::type>
+	InplaceFunction(F&& function)
+		: storage()
+	{
+		static_assert(sizeof(D) <= Capacity, "Callable is too large for the InplaceFunction capacity, capture less state or increase Capacity.");
+		static_assert(alignof(D) <= Alignment, "Callable is over-aligned for InplaceFunction.");
+		static_assert(std::is_trivially_copyable<D>::value, "Callable must be trivially copyable, capture pointers or values instead of owning objects.");
+		static_assert(std::is_trivially_destructible<D>::value, "Callable must be trivially destructible.");
+
+		new (storage) D(std::forward<F>(function));
+		invoker = &Invoke<D>;
+	}
+
+	InplaceFunction& operator=(std::nullptr_t)
+	{
+		invoker = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief Call the stored callable
+	 * @remark Calling an empty `InplaceFunction` is undefined behaviour
+	 */
+	R operator()(Args... args) const
+	{
+		return invoker(storage, std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Get whether a callable is stored
+	 */
+	explicit operator bool() const { return invoker != nullptr; }
+
+	friend bool operator==(const InplaceFunction& function, std::nullptr_t) { return function.invoker == nullptr; }
+	friend bool operator==(std::nullptr_t, const InplaceFunction& function) { return function.invoker == nullptr; }
+	friend bool operator!=(const InplaceFunction& function, std::nullptr_t) { return function.invoker != nullptr; }
+	friend bool operator!=(std::nullptr_t, const InplaceFunction& function) { return function.invoker != nullptr; }
+};
+
+} // namespace PSR
@@ -1,25 +1,175 @@
 #pragma once
 
+#include "inplace_function.hpp"
+
 #include "stm32_includer.h"
 #include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
 #include STM32_INCLUDE(STM32_PROCESSOR, hal_def.h)
 
 #include <array>
-#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 
 namespace PSR
 {
 
+class HighPrecisionCounter;
+
+/// @brief The priority lane of a queued callback, higher priorities are run first
+enum class InterruptPriority : uint8_t
+{
+	Low    = 0, ///< @brief Telemetry, logging and other work that can wait
+	Normal = 1, ///< @brief The default priority
+	High   = 2, ///< @brief Safety critical work that must not wait behind other callbacks
+};
+
+/**
+ * @brief Queue to allow generating callbacks during interrupts that get run in a non-interrupt context
+ *
+ * @remark Each priority lane is a bounded ring where every slot carries a sequence number.
+ * Interrupts claim a slot with a compare-and-swap on the tail (LDREX/STREX on Cortex-M3 and up),
+ * so enqueueing never disables interrupts and nested interrupts can enqueue concurrently.
+ * Only the main loop drains the queue, highest priority first and in FIFO order within a lane.
+ */
 class InterruptQueue
 {
+  public:
+	static constexpr size_t PriorityCount = 3;
+	/// @brief Passed to `HandleQueue` to run every pending callback regardless of time
+	static constexpr uint32_t NoBudget = std::numeric_limits<uint32_t>::max();
+
+	/// @brief Counters for sizing a lane and checking its deadlines from real data
+	struct Statistics
+	{
+		uint32_t Enqueued;      ///< @brief The number of callbacks added to the lane
+		uint32_t Dropped;       ///< @brief The number of callbacks rejected because the lane was full
+		uint32_t HighWatermark; ///< @brief The largest number of callbacks pending at once
+		uint32_t Run;           ///< @brief The number of callbacks run with a known enqueue time
+		uint32_t MinLatency;    ///< @brief The shortest enqueue to run time in microseconds
+		uint32_t MaxLatency;    ///< @brief The longest enqueue to run time in microseconds
+		uint64_t TotalLatency;  ///< @brief The sum of all enqueue to run times in microseconds
+
+		/// @brief Get the mean enqueue to run time in microseconds
+		uint32_t GetMeanLatency() const { return Run == 0 ? 0 : (uint32_t)(TotalLatency / Run); }
+	};
+
+  private:
 	static constexpr size_t MaxDepth = 32;
-	static std::array<std::function<void()>, MaxDepth> Queue;
-	static volatile size_t InterruptsPending;
+	static_assert((MaxDepth & (MaxDepth - 1)) == 0, "MaxDepth must be a power of two");
+
+	struct Slot
+	{
+		/// @brief The lap this slot is on, relative to its index
+		/// @remark Equal to `position - index` when the slot is free for `position`, and one more once it is filled
+		std::atomic<uint32_t> Sequence;
+		InplaceFunction<void()> Callback;
+		/// @brief The time the callback was queued, in microseconds
+		uint64_t EnqueueTime;
+		/// @brief Whether a time source was set when the callback was queued, every count including zero is a valid time
+		bool HasEnqueueTime;
+	};
+
+	struct Lane
+	{
+		std::array<Slot, MaxDepth> Slots;
+		/// @brief The position of the next callback to run, only written by the main loop
+		std::atomic<uint32_t> Head;
+		/// @brief The position of the next free slot, claimed by interrupts
+		std::atomic<uint32_t> Tail;
+
+		std::atomic<uint32_t> Enqueued;
+		std::atomic<uint32_t> Dropped;
+		std::atomic<uint32_t> HighWatermark;
+
+		/// @brief Latency counters, only written by the main loop
+		uint32_t Run;
+		uint32_t MinLatency;
+		uint32_t MaxLatency;
+		uint64_t TotalLatency;
+	};
+
+	static std::array<Lane, PriorityCount> Lanes;
+	/// @brief The counter used to timestamp callbacks and measure the drain budget
+	static const HighPrecisionCounter* TimeSource;
+
+	static bool RunNext(Lane& lane, uint32_t end);
 
   public:
-	static bool AddInterrupt(const std::function<void()>& callback) __attribute__((section(".RamFunc")));
+	/**
+	 * @brief Add a callback to be run from the main loop
+	 * @remark Safe to call from any interrupt priority
+	 *
+	 * @param callback The callback to run
+	 * @param priority The priority lane to add the callback to
+	 * @return `bool` Whether the callback was added, false if the lane is full
+	 */
+	static bool AddInterrupt(const InplaceFunction<void()>& callback, InterruptPriority priority = InterruptPriority::Normal) __attribute__((section(".RamFunc")));
+
+	/**
+	 * @brief Run the pending callbacks
+	 * @remark Higher priority lanes are always drained first, callbacks within a lane run in the order they were added.
+	 * A lane is drained up to what it held when the drain reached it, callbacks added to a higher lane meanwhile run before the rest of it.
+	 * Each lane runs at most `GetDepth()` more callbacks than it held on entry, so callbacks that queue more work cannot keep this from returning.
+	 * This function must not be called from an interrupt
+	 *
+	 * @param budgetMicroseconds Stop starting new callbacks once this much time has passed, at least one callback is always run.
+	 * Requires a time source, see `SetTimeSource`
+	 */
+	static void HandleQueue(uint32_t budgetMicroseconds = NoBudget) __attribute__((section(".RamFunc")));
+
+	/**
+	 * @brief Set the counter used to measure callback latency and the drain budget
+	 *
+	 * @param counter An initialized counter, or `nullptr` to disable timing
+	 */
+	static void SetTimeSource(const HighPrecisionCounter* counter) { TimeSource = counter; }
+
+	/**
+	 * @brief Get the number of callbacks waiting to be run in a lane
+	 *
+	 * @param priority The priority lane
+	 * @return `size_t` The number of pending callbacks
+	 */
+	static size_t GetPending(InterruptPriority priority)
+	{
+		const Lane& lane = Lanes[(size_t)priority];
+		return lane.Tail.load(std::memory_order_relaxed) - lane.Head.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the number of callbacks waiting to be run in all lanes
+	 *
+	 * @return `size_t` The number of pending callbacks
+	 */
+	static size_t GetPending()
+	{
+		size_t pending = 0;
+		for (size_t i = 0; i < PriorityCount; i++)
+			pending += GetPending((InterruptPriority)i);
+
+		return pending;
+	}
+
+	/**
+	 * @brief Get the maximum number of callbacks that can be pending at once in each lane
+	 *
+	 * @return `size_t` The lane depth
+	 */
+	static constexpr size_t GetDepth() { return MaxDepth; }
+
+	/**
+	 * @brief Get the counters of a lane
+	 *
+	 * @param priority The priority lane
+	 * @return `Statistics` The current counters
+	 */
+	static Statistics GetStatistics(InterruptPriority priority);
 
-	static void HandleQueue() __attribute__((section(".RamFunc")));
+	/**
+	 * @brief Reset the counters of all lanes
+	 */
+	static void ResetStatistics();
 };
 
 } // namespace PSR
@@ -2,40 +2,329 @@
  * @file memory_operations.hpp
  * @author Purdue Solar Racing (Aidan Orr)
  * @brief Memory operations for reading and writing data
- * @version 0.1
- * 
+ * @version 0.3
+ *
  * @copyright Copyright (c) 2025
- * 
+ *
  */
 #pragma once
 
+#include "bit_operations.h"
+#include "byte_swap.hpp"
+
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace PSR
+{
+
+template <size_t Size>
+struct UnsignedOfSize;
+
+template <>
+struct UnsignedOfSize<1>
+{
+	using Type = uint8_t;
+};
+
+template <>
+struct UnsignedOfSize<2>
+{
+	using Type = uint16_t;
+};
+
+template <>
+struct UnsignedOfSize<4>
+{
+	using Type = uint32_t;
+};
+
+template <>
+struct UnsignedOfSize<8>
+{
+	using Type = uint64_t;
+};
+
+/// @brief The unsigned integer with the same size as `T`, used to move the bytes of a value
+template <typename T>
+using SerializedBits = typename UnsignedOfSize<sizeof(T)>::Type;
+
+template <typename T>
+constexpr SerializedBits<T> toSerializedBits(T value)
+{
+	static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only arithmetic and enum types can be serialized");
+
+	if constexpr (std::is_floating_point<T>::value)
+	{
+		SerializedBits<T> bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	else
+	{
+		return (SerializedBits<T>)value;
+	}
+}
+
+template <typename T>
+constexpr T fromSerializedBits(SerializedBits<T> bits)
+{
+	static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only arithmetic and enum types can be serialized");
+
+	if constexpr (std::is_floating_point<T>::value)
+	{
+		T value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	else
+	{
+		return (T)bits;
+	}
+}
+
+/**
+ * @brief Load the bytes of a value at any alignment in the processor's byte order
+ * @remark A single load on cores that allow unaligned access and byte loads on the others. The compiler merges the byte stores
+ * of the writes below on its own, but not the byte loads of the reads, so they use this outside constant evaluation
+ */
+template <typename T>
+inline SerializedBits<T> loadSerializedBits(const uint8_t* data)
+{
+	SerializedBits<T> bits;
+	memcpy(&bits, data, sizeof(bits));
+	return bits;
+}
+
+} // namespace PSR
+
+// The byte loops below are merged by the compiler into a single store, with a byte reverse when the order differs, and the
+// reads load the whole value at once at run time. Cores that do not allow unaligned access, such as the Cortex-M0, get byte
+// accesses instead of a fault. Integer and enum versions are constexpr, floating point values are only converted at run time.
+
+/**
+ * @brief Read a little endian value from a byte array at any alignment
+ *
+ * @tparam T The type of the value to read
+ * @param data The byte array to read from
+ * @param offset The byte offset in the array to read from
+ * @return T The value read from the array
+ */
+template <typename T>
+static inline constexpr T readLittleEndian(const uint8_t* data, size_t offset = 0)
+{
+	using Bits = PSR::SerializedBits<T>;
+
+	if (!__builtin_is_constant_evaluated())
+	{
+		Bits bits = PSR::loadSerializedBits<T>(data + offset);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		bits = PSR::reverseEndianness(bits);
+#endif
+		return PSR::fromSerializedBits<T>(bits);
+	}
+
+	Bits bits = 0;
+#pragma GCC unroll 8
+	for (size_t i = 0; i < sizeof(T); i++)
+		bits |= (Bits)data[offset + i] << (8 * i);
+
+	return PSR::fromSerializedBits<T>(bits);
+}
+
+/**
+ * @brief Read a big endian value from a byte array at any alignment
+ *
+ * @tparam T The type of the value to read
+ * @param data The byte array to read from
+ * @param offset The byte offset in the array to read from
+ * @return T The value read from the array
+ */
+template <typename T>
+static inline constexpr T readBigEndian(const uint8_t* data, size_t offset = 0)
+{
+	using Bits = PSR::SerializedBits<T>;
+
+	if (!__builtin_is_constant_evaluated())
+	{
+		Bits bits = PSR::loadSerializedBits<T>(data + offset);
+#if __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+		bits = PSR::reverseEndianness(bits);
+#endif
+		return PSR::fromSerializedBits<T>(bits);
+	}
+
+	Bits bits = 0;
+#pragma GCC unroll 8
+	for (size_t i = 0; i < sizeof(T); i++)
+		bits |= (Bits)data[offset + i] << (8 * (sizeof(T) - 1 - i));
+
+	return PSR::fromSerializedBits<T>(bits);
+}
+
+/**
+ * @brief Write a value to a byte array in little endian order at any alignment
+ *
+ * @tparam T The type of the value to write
+ * @param value The value to write
+ * @param data The byte array to write to
+ * @param offset The byte offset in the array to write to
+ */
+template <typename T>
+static inline constexpr void writeLittleEndian(T value, uint8_t* data, size_t offset = 0)
+{
+	auto bits = PSR::toSerializedBits(value);
+
+#pragma GCC unroll 8
+	for (size_t i = 0; i < sizeof(T); i++)
+		data[offset + i] = (uint8_t)(bits >> (8 * i));
+}
+
+/**
+ * @brief Write a value to a byte array in big endian order at any alignment
+ *
+ * @tparam T The type of the value to write
+ * @param value The value to write
+ * @param data The byte array to write to
+ * @param offset The byte offset in the array to write to
+ */
+template <typename T>
+static inline constexpr void writeBigEndian(T value, uint8_t* data, size_t offset = 0)
+{
+	auto bits = PSR::toSerializedBits(value);
+
+#pragma GCC unroll 8
+	for (size_t i = 0; i < sizeof(T); i++)
+		data[offset + i] = (uint8_t)(bits >> (8 * (sizeof(T) - 1 - i)));
+}
 
 /**
- * @brief Read a value from a byte array
- * 
+ * @brief Read a value in the processor's byte order from a byte array at any alignment
+ *
  * @tparam T The type of the value to read
  * @param data The byte array to read from
  * @param offset The byte offset in the array to read from
  * @return T The value read from the array
  */
 template <typename T>
-static inline const T& read(const uint8_t* data, size_t offset = 0)
+static inline constexpr T read(const uint8_t* data, size_t offset = 0)
 {
-	return *reinterpret_cast<const T*>(data + offset);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return readBigEndian<T>(data, offset);
+#else
+	return readLittleEndian<T>(data, offset);
+#endif
 }
 
 /**
- * @brief Write a value to a byte array
- * 
+ * @brief Write a value to a byte array in the processor's byte order at any alignment
+ *
  * @tparam T The type of the value to write
  * @param value The value to write
  * @param data The byte array to write to
  * @param offset The byte offset in the array to write to
  */
 template <typename T>
-static inline void write(T value, uint8_t* data, size_t offset = 0)
+static inline constexpr void write(T value, uint8_t* data, size_t offset = 0)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	writeBigEndian(value, data, offset);
+#else
+	writeLittleEndian(value, data, offset);
+#endif
+}
+
+/**
+ * @brief Copy an array of values out of a byte array, converting each from a byte order
+ * @remark Arithmetic values are converted in one pass by the `byte_swap.hpp` kernels when the order differs from the processor's,
+ * and copied as one block otherwise
+ *
+ * @tparam T The type of the values
+ * @tparam BigEndian Whether the bytes are in big endian order
+ * @param data The byte array to read from
+ * @param values The array to read into
+ * @param count The number of values
+ * @param offset The byte offset in the array to read from
+ */
+template <typename T, bool BigEndian>
+static inline void readArray(const uint8_t* data, T* values, size_t count, size_t offset = 0)
+{
+	constexpr bool reverse = BigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+
+	if constexpr (std::is_arithmetic<T>::value && reverse && sizeof(T) > 1)
+	{
+		PSR::reverseElementBytes<sizeof(T)>(data + offset, values, count);
+	}
+	else if constexpr (std::is_arithmetic<T>::value)
+	{
+		memcpy(values, data + offset, count * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = 0; i < count; i++)
+			values[i] = BigEndian ? readBigEndian<T>(data, offset + i * sizeof(T)) : readLittleEndian<T>(data, offset + i * sizeof(T));
+	}
+}
+
+/**
+ * @brief Copy an array of values into a byte array, converting each to a byte order
+ * @remark Arithmetic values are converted in one pass by the `byte_swap.hpp` kernels when the order differs from the processor's,
+ * and copied as one block otherwise
+ *
+ * @tparam T The type of the values
+ * @tparam BigEndian Whether to write the bytes in big endian order
+ * @param values The array to write
+ * @param count The number of values
+ * @param data The byte array to write to
+ * @param offset The byte offset in the array to write to
+ */
+template <typename T, bool BigEndian>
+static inline void writeArray(const T* values, size_t count, uint8_t* data, size_t offset = 0)
+{
+	constexpr bool reverse = BigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+
+	if constexpr (std::is_arithmetic<T>::value && reverse && sizeof(T) > 1)
+	{
+		PSR::reverseElementBytes<sizeof(T)>(values, data + offset, count);
+	}
+	else if constexpr (std::is_arithmetic<T>::value)
+	{
+		memcpy(data + offset, values, count * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			if (BigEndian)
+				writeBigEndian(values[i], data, offset + i * sizeof(T));
+			else
+				writeLittleEndian(values[i], data, offset + i * sizeof(T));
+		}
+	}
+}
+
+template <typename T>
+static inline void readArrayLittleEndian(const uint8_t* data, T* values, size_t count, size_t offset = 0)
+{
+	readArray<T, false>(data, values, count, offset);
+}
+
+template <typename T>
+static inline void readArrayBigEndian(const uint8_t* data, T* values, size_t count, size_t offset = 0)
+{
+	readArray<T, true>(data, values, count, offset);
+}
+
+template <typename T>
+static inline void writeArrayLittleEndian(const T* values, size_t count, uint8_t* data, size_t offset = 0)
+{
+	writeArray<T, false>(values, count, data, offset);
+}
+
+template <typename T>
+static inline void writeArrayBigEndian(const T* values, size_t count, uint8_t* data, size_t offset = 0)
 {
-	*reinterpret_cast<T*>(data + offset) = value;
+	writeArray<T, true>(values, count, data, offset);
 }
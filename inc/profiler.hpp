@@ -0,0 +1,204 @@
+/**
+ * @file profiler.hpp
+ * @author Purdue Solar Racing
+ * @brief Cycle counter profiling zones with per zone histograms
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "stm32_includer.h"
+#include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
+
+#include "bit_operations.h"
+
+#ifdef STM32_HOST_SIMULATION
+#include <chrono>
+#else
+#include "cycle_counter.hpp"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Places a zone's entry in the table the linker builds from `__start_profile_zones` to `__stop_profile_zones`
+#define PROFILER_ZONE_SECTION __attribute__((section("profile_zones"), used))
+
+/**
+ * @brief Time the rest of the enclosing scope as a profiling zone
+ * @remark Compiles to nothing unless `ENABLE_PROFILING` is defined. The zone and its entry in the `profile_zones` section are
+ * constant initialized, so entering a zone never takes a guard or a lock and is safe in interrupts
+ *
+ * @param name The name of the zone, must be a string literal or otherwise outlive the program
+ */
+#ifdef ENABLE_PROFILING
+#define PROFILE_ZONE(name)                                                                                                   \
+	static ::PSR::Profiler::Zone CAT(profileZone, __LINE__)(name);                                                           \
+	static ::PSR::Profiler::Zone* const CAT(profileZoneEntry, __LINE__) PROFILER_ZONE_SECTION = &CAT(profileZone, __LINE__); \
+	::PSR::ProfileZone CAT(profileZoneScope, __LINE__)(CAT(profileZone, __LINE__))
+#else
+#define PROFILE_ZONE(name) \
+	do                     \
+	{                      \
+	} while (0)
+#endif
+
+namespace PSR
+{
+
+/**
+ * @brief Statically allocated profiling zones
+ * @remark Times are in core clock cycles from the DWT cycle counter. On cores without one, where `CYCLE_COUNTER_AVAILABLE` is not
+ * defined, they are SysTick counts extended by the HAL tick, which is core clock cycles when SysTick runs from the core clock.
+ * On the host simulation they are in nanoseconds from the steady clock, so zones still measure real time when the simulated
+ * cycle counter follows the virtual clock.
+ * Recording a sample is a handful of plain stores with no locking, so a zone entered from an interrupt while it is being
+ * recorded in thread mode can lose a sample. Give zones that run in both contexts different names.
+ *
+ * Every `PROFILE_ZONE` adds a pointer to its zone to the `profile_zones` section, which the linker gathers into one table
+ * between `__start_profile_zones` and `__stop_profile_zones`. A linker script that discards unlisted sections has to
+ * `KEEP(*(profile_zones))` in flash
+ */
+class Profiler
+{
+  public:
+	/// @brief Bin 0 counts zero length samples, bin `k` counts samples in `[2^(k-1), 2^k)` ticks, the last bin also counts longer ones
+	static constexpr size_t HistogramBins = 32;
+
+	/// @brief The samples recorded for one zone, in profiler ticks
+	struct Zone
+	{
+		const char* Name;                  ///< @brief The name given to `PROFILE_ZONE`
+		uint32_t Calls;                    ///< @brief The number of samples
+		uint32_t MinTicks;                 ///< @brief The shortest sample, `UINT32_MAX` before the first one
+		uint32_t MaxTicks;                 ///< @brief The longest sample
+		uint64_t TotalTicks;               ///< @brief The sum of all samples
+		uint32_t Histogram[HistogramBins]; ///< @brief The number of samples in each power of two bin
+
+		/// @brief Constexpr so that a zone is constant initialized and a function-local one needs no guard
+		explicit constexpr Zone(const char* name)
+			: Name(name), Calls(0), MinTicks(UINT32_MAX), MaxTicks(0), TotalTicks(0), Histogram {}
+		{}
+
+		uint32_t GetMeanTicks() const { return Calls == 0 ? 0 : (uint32_t)(TotalTicks / Calls); }
+	};
+
+  private:
+	static size_t GetBin(uint32_t ticks)
+	{
+		if (ticks == 0)
+			return 0;
+
+		size_t bin = 32 - countLeadingZeros(ticks);
+		return bin < HistogramBins ? bin : HistogramBins - 1;
+	}
+
+  public:
+	/**
+	 * @brief Get the current time in profiler ticks
+	 */
+	static uint32_t GetTicks()
+	{
+#ifdef STM32_HOST_SIMULATION
+		return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#elif defined(CYCLE_COUNTER_AVAILABLE)
+		return CycleCounter::GetCount();
+#else
+		// SysTick counts down from LOAD and raises the HAL tick when it wraps. A wrap that has not been counted yet, because
+		// its interrupt is pending behind the caller, is added here so the ticks never go backwards
+		uint32_t reload = SysTick->LOAD + 1;
+		uint32_t tick;
+		uint32_t value;
+		bool wrapped;
+		do
+		{
+			tick    = HAL_GetTick();
+			value   = SysTick->VAL;
+			wrapped = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+			// The first value may be from before or after the wrap, the second is after it
+			if (wrapped)
+				value = SysTick->VAL;
+		} while (tick != HAL_GetTick());
+
+		if (wrapped)
+			tick += (uint32_t)HAL_GetTickFreq();
+
+		return tick / (uint32_t)HAL_GetTickFreq() * reload + (reload - 1 - value);
+#endif
+	}
+
+	/**
+	 * @brief Get the number of profiler ticks per second
+	 */
+	static uint32_t GetTickFrequency();
+
+	/**
+	 * @brief Start the cycle counter the zones are timed with, call once at startup before any zone is entered
+	 * @remark Does nothing on cores without a cycle counter, SysTick is already running for the HAL tick
+	 */
+	static void Init();
+
+	/**
+	 * @brief Add a sample to a zone
+	 *
+	 * @param zone The zone
+	 * @param ticks The length of the sample in profiler ticks
+	 */
+	static void Record(Zone& zone, uint32_t ticks)
+	{
+		zone.Calls++;
+		zone.TotalTicks += ticks;
+		if (ticks < zone.MinTicks)
+			zone.MinTicks = ticks;
+		if (ticks > zone.MaxTicks)
+			zone.MaxTicks = ticks;
+		zone.Histogram[GetBin(ticks)]++;
+	}
+
+	/**
+	 * @brief Get the number of zones in the program
+	 */
+	static size_t GetZoneCount();
+
+	/**
+	 * @brief Get a zone's statistics
+	 *
+	 * @param id The index of the zone, less than `GetZoneCount()`
+	 * @return `const Zone&` The zone
+	 */
+	static const Zone& GetZone(size_t id);
+
+	/**
+	 * @brief Clear the samples of every zone
+	 */
+	static void Reset();
+
+	/**
+	 * @brief Print every zone and its non-empty histogram bins through `print_debug`
+	 */
+	static void Dump();
+};
+
+/**
+ * @brief Records the time from its construction to its destruction into a profiling zone
+ */
+class ProfileZone
+{
+  private:
+	Profiler::Zone& zone;
+	const uint32_t start;
+
+  public:
+	explicit ProfileZone(Profiler::Zone& zone)
+		: zone(zone), start(Profiler::GetTicks())
+	{}
+
+	~ProfileZone() { Profiler::Record(zone, Profiler::GetTicks() - start); }
+
+	ProfileZone(const ProfileZone&)            = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+} // namespace PSR
@@ -0,0 +1,213 @@
+/**
+ * @file register_field.hpp
+ * @author Purdue Solar Racing
+ * @brief Typed peripheral register fields that are combined at compile time into single register accesses
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace PSR
+{
+
+namespace Detail
+{
+
+// Not constexpr, so a field value that does not fit is a compile error where `Field::Of` is constant evaluated
+inline void FieldValueTooWide() {}
+
+} // namespace Detail
+
+/**
+ * @brief A value read from a register, from which fields are taken without reading the register again
+ */
+template <typename Reg>
+class RegisterValue
+{
+  private:
+	uint32_t value;
+
+  public:
+	explicit constexpr RegisterValue(uint32_t value) : value(value) {}
+
+	constexpr uint32_t GetValue() const { return value; }
+};
+
+/**
+ * @brief The bits of one or more fields of a register
+ * @remark Values for the same register are combined with `|`, which fails to compile when a field is given twice
+ * or the fields belong to different registers
+ *
+ * @tparam Reg The `Register` the fields belong to
+ * @tparam Mask The bits covered by the fields
+ */
+template <typename Reg, uint32_t Mask>
+class FieldValue
+{
+  private:
+	uint32_t bits;
+
+  public:
+	using RegisterType = Reg;
+	static constexpr uint32_t FieldMask = Mask;
+
+	explicit constexpr FieldValue(uint32_t bits) : bits(bits) {}
+
+	/// @brief Get the field bits in their register positions
+	constexpr uint32_t GetBits() const { return bits; }
+
+	template <typename OtherReg, uint32_t OtherMask>
+	constexpr FieldValue<Reg, Mask | OtherMask> operator|(FieldValue<OtherReg, OtherMask> other) const
+	{
+		static_assert(std::is_same<Reg, OtherReg>::value, "Fields of different registers cannot be combined");
+		static_assert((Mask & OtherMask) == 0, "A field is given more than once");
+
+		return FieldValue<Reg, Mask | OtherMask>(bits | other.GetBits());
+	}
+};
+
+/**
+ * @brief A field of a peripheral register
+ *
+ * @tparam Reg The `Register` the field belongs to
+ * @tparam Offset The position of the least significant bit of the field
+ * @tparam Width The number of bits in the field
+ */
+template <typename Reg, unsigned int Offset, unsigned int Width>
+struct Field
+{
+	static_assert(Width >= 1 && Offset + Width <= 32, "The field does not fit in a 32-bit register");
+
+	static constexpr uint32_t Max  = Width == 32 ? 0xFFFFFFFF : (1u << Width) - 1;
+	static constexpr uint32_t Mask = Max << Offset;
+
+	using Value = FieldValue<Reg, Mask>;
+
+	/**
+	 * @brief Create a value for the field from a constant
+	 * @remark A value that does not fit is a compile error
+	 *
+	 * @tparam FieldValue The field value
+	 * @return `Value` The field value in its register position
+	 */
+	template <uint32_t FieldValue>
+	static constexpr Value Of()
+	{
+		static_assert(FieldValue <= Max, "The value does not fit in the field");
+
+		return Value(FieldValue << Offset);
+	}
+
+	/**
+	 * @brief Create a value for the field from a value known only at run time
+	 * @remark A value that does not fit is truncated to the width of the field. It is only a compile error where the call
+	 * is constant evaluated, such as the initializer of a `constexpr` variable, so use `Of<value>()` for constants
+	 *
+	 * @param value The field value
+	 * @return `Value` The field value in its register position
+	 */
+	static constexpr Value Of(uint32_t value)
+	{
+		if (value > Max)
+			Detail::FieldValueTooWide();
+
+		return Value((value << Offset) & Mask);
+	}
+
+	/// @brief The value with every bit of the field set
+	static constexpr Value Set = Value(Mask);
+	/// @brief The value with every bit of the field cleared
+	static constexpr Value Clear = Value(0);
+
+	/// @brief Get the field from a register value read earlier
+	static constexpr uint32_t Get(RegisterValue<Reg> value) { return (value.GetValue() & Mask) >> Offset; }
+
+	/// @brief Whether every bit of the field is set in a register value read earlier
+	static constexpr bool IsSet(RegisterValue<Reg> value) { return (value.GetValue() & Mask) == Mask; }
+
+	/**
+	 * @brief Read the field from a peripheral, one register read
+	 *
+	 * @param peripheral The peripheral to read
+	 * @return `uint32_t` The field value
+	 */
+	static uint32_t Read(const volatile typename Reg::PeripheralType* peripheral) { return Get(Reg::Read(peripheral)); }
+};
+
+/**
+ * @brief A 32-bit register of a peripheral
+ * @remark Works on any register type that converts to and is assigned from `uint32_t`, including `volatile uint32_t`
+ * and the registers of the host simulation
+ *
+ * @tparam Peripheral The peripheral structure, such as `TIM_TypeDef`
+ * @tparam Member The register member, such as `&TIM_TypeDef::CR1`
+ * @tparam ResetValue The value of the register after reset, used for the bits not given to `writeRegister`
+ * @tparam ImplementedMask The bits that exist in the register, `modifyRegister` writes without reading when every one is given
+ */
+template <typename Peripheral, auto Member, uint32_t ResetValue = 0, uint32_t ImplementedMask = 0xFFFFFFFF>
+struct Register
+{
+	using PeripheralType = Peripheral;
+
+	static constexpr uint32_t Reset   = ResetValue;
+	static constexpr uint32_t Defined = ImplementedMask;
+
+	/// @brief Read the register once
+	static RegisterValue<Register> Read(const volatile Peripheral* peripheral) { return RegisterValue<Register>(peripheral->*Member); }
+
+	/// @brief Write a value to the register
+	static void WriteValue(volatile Peripheral* peripheral, uint32_t value) { peripheral->*Member = value; }
+
+	/// @brief Return the register to its reset value
+	static void ResetRegister(volatile Peripheral* peripheral) { WriteValue(peripheral, ResetValue); }
+};
+
+/**
+ * @brief Write fields to a register with a single write, the bits of the other fields take their reset values
+ *
+ * @param peripheral The peripheral to write
+ * @param fields The fields to write
+ */
+template <typename Reg, uint32_t Mask>
+inline void writeRegister(volatile typename Reg::PeripheralType* peripheral, FieldValue<Reg, Mask> fields)
+{
+	Reg::WriteValue(peripheral, (Reg::Reset & ~Mask) | fields.GetBits());
+}
+
+/**
+ * @brief Change fields of a register with a single read and write, the other fields keep their values
+ * @remark When the fields cover every implemented bit the register is written without being read
+ *
+ * @param peripheral The peripheral to change
+ * @param fields The fields to change
+ */
+template <typename Reg, uint32_t Mask>
+inline void modifyRegister(volatile typename Reg::PeripheralType* peripheral, FieldValue<Reg, Mask> fields)
+{
+	if constexpr ((Mask & Reg::Defined) == Reg::Defined)
+		Reg::WriteValue(peripheral, fields.GetBits());
+	else
+		Reg::WriteValue(peripheral, (Reg::Read(peripheral).GetValue() & ~Mask) | fields.GetBits());
+}
+
+/**
+ * @brief Clear flags in a register whose bits are cleared by writing zero and unchanged by writing one, such as a timer `SR`
+ * @remark Flags raised by the hardware between a read and a write would be lost by a read-modify-write, this is a single write
+ *
+ * @param peripheral The peripheral to change
+ * @param flags The flags to clear, the field values are ignored
+ */
+template <typename Reg, uint32_t Mask>
+inline void clearRegisterFlags(volatile typename Reg::PeripheralType* peripheral, FieldValue<Reg, Mask> flags)
+{
+	(void)flags;
+	Reg::WriteValue(peripheral, ~Mask);
+}
+
+} // namespace PSR
@@ -9,7 +9,11 @@
  */
 #pragma once
 
+#include "inplace_function.hpp"
 #include "interrupt_queue.hpp"
+#include "cycle_counter.hpp"
+#include "status.hpp"
+#include "timer_registers.hpp"
 #include "timer_helpers.h"
 
 #include "stm32_includer.h"
@@ -21,7 +25,6 @@
 #include <array>
 #include <bitset>
 #include <cstdint>
-#include <functional>
 #include <limits>
 
 namespace PSR
@@ -37,11 +40,52 @@ class Scheduler
   private:
 	static constexpr size_t MaxTasks = 32;
 
+  public:
+#ifdef SCHEDULER_STATISTICS
+	/**
+	 * @brief Runtime counters for a single task
+	 * @remark All times are in core clock cycles from `CycleCounter`, use `CycleCounter::ToMicroseconds` to convert them.
+	 * Without a cycle counter they are scheduler timer counts scaled to core clock cycles, so their resolution is one timer count.
+	 * Jitter is the delay from the task being added to the interrupt queue to it starting to run
+	 */
+	struct TaskStatistics
+	{
+		uint32_t ReleaseTime;        ///< @brief When the task was last added to the interrupt queue
+		uint32_t StartTime;          ///< @brief When the task last started running
+		uint32_t ExecutionTime;      ///< @brief How long the last run took
+		uint32_t MaxExecutionTime;   ///< @brief The longest run
+		uint64_t TotalExecutionTime; ///< @brief The sum of all runs
+		uint32_t MinJitter;          ///< @brief The shortest delay from release to start, `UINT32_MAX` before the first run
+		uint32_t MaxJitter;          ///< @brief The longest delay from release to start
+		uint64_t TotalJitter;        ///< @brief The sum of all delays from release to start
+		uint32_t Runs;               ///< @brief The number of times the task ran
+		uint32_t MissedDeadlines;    ///< @brief The number of times the task was released again before its previous release ran
+
+		/// @remark Every missed deadline queues one extra run that has no release of its own to measure jitter from
+		uint32_t GetMeanJitter() const { return Runs <= MissedDeadlines ? 0 : (uint32_t)(TotalJitter / (Runs - MissedDeadlines)); }
+		uint32_t GetMeanExecutionTime() const { return Runs == 0 ? 0 : (uint32_t)(TotalExecutionTime / Runs); }
+	};
+
+	/// @brief The counters for every task slot, indexed by task id
+	using Statistics = std::array<TaskStatistics, MaxTasks>;
+#endif
+
+  private:
+
+	/// @brief The number of slots in the timing wheel, must be a power of two
+	static constexpr size_t WheelSize = 64;
+	static constexpr size_t WheelMask = WheelSize - 1;
+	/// @brief Marks the end of a timing wheel slot list
+	static constexpr uint8_t EndOfList = 0xFF;
+
+	static_assert((WheelSize & WheelMask) == 0, "WheelSize must be a power of two");
+	static_assert(MaxTasks < EndOfList, "Task indices must fit in a wheel link");
+
 	/// @brief The timer peripheral to use for the scheduler
 	TIM_TypeDef* const tim;
 	/// @brief The tasks to run
 	/// @remark `nullptr` indicates an empty slot
-	std::array<std::function<void()>, MaxTasks> tasks = { nullptr };
+	std::array<InplaceFunction<void()>, MaxTasks> tasks = { nullptr };
 	/// @brief The intervals at which to run the tasks
 	std::array<uint32_t, MaxTasks> intervals = { 0 };
 	/// @brief The offset from zero at which the tasks will run
@@ -50,6 +94,22 @@ class Scheduler
 	std::array<uint32_t, MaxTasks> nextUpdates = { 0 };
 	/// @brief The enabled tasks
 	std::bitset<MaxTasks> enabledTasks;
+	/// @brief The tasks that run directly in the timer interrupt instead of through the interrupt queue
+	std::bitset<MaxTasks> interruptTasks;
+	/// @brief The execution time budget of each interrupt task in core clock cycles
+	std::array<uint32_t, MaxTasks> budgets = { 0 };
+	/// @brief The longest measured execution time of each interrupt task in core clock cycles
+	std::array<uint32_t, MaxTasks> worstExecutionTimes = { 0 };
+	/// @brief The number of times each interrupt task ran over its budget
+	std::array<uint32_t, MaxTasks> overruns = { 0 };
+
+	/// @brief The first task in each timing wheel slot
+	/// @remark A task is linked into the slot `nextUpdates[i] & WheelMask`, so each tick only visits the tasks that can be due
+	std::array<uint8_t, WheelSize> wheel;
+	/// @brief The next task in the same timing wheel slot
+	std::array<uint8_t, MaxTasks> wheelNext;
+	/// @brief The timing wheel slot each task is currently linked into
+	std::array<uint8_t, MaxTasks> wheelSlots;
 
 	/// @brief The internal counter used to track the scheduler
 	uint32_t counter = 0;
@@ -60,9 +120,36 @@ class Scheduler
 	const uint32_t timerPrecision;
 	/// @brief The number of ticks before the scheduler rolls over
 	const uint32_t timerRollOver;
-
-	/// @brief The highest index of a task in the scheduler
-	size_t highestTaskIndex = 0;
+	/// @brief Whether the timer is reprogrammed to interrupt only when a task is due
+	const bool tickless;
+
+#ifndef CYCLE_COUNTER_AVAILABLE
+	/// @brief The number of core clock cycles per scheduler timer count, scales the timestamps
+	uint32_t cyclesPerTimerCount = 1;
+	/// @brief The number of timer counts in the periods before the current one, modulo `2^32`
+	uint32_t timerCountBase = 0;
+#endif
+
+	/// @brief The number of ticks in the current timer period, in tickless mode
+	uint32_t periodTicks = 0;
+	/// @brief The longest period the timer can be programmed for, in tickless mode
+	uint32_t maxPeriodTicks = 0;
+
+#ifdef SCHEDULER_STATISTICS
+	/// @brief The runtime counters of each task
+	Statistics statistics;
+	/// @brief The tasks that have been released and not yet started
+	std::bitset<MaxTasks> released;
+
+	/// @brief The cycle count when the current timer interrupt started, the release time of interrupt tasks
+	uint32_t tickStartTime = 0;
+
+	/// @brief Run a released task, measuring its jitter and execution time
+	void RunTask(size_t index);
+	/// @brief Add a run of a task to its statistics
+	void RecordRun(size_t index, uint32_t start, uint32_t end, bool measureJitter);
+	static constexpr TaskStatistics EmptyStatistics = { 0, 0, 0, 0, 0, std::numeric_limits<uint32_t>::max(), 0, 0, 0, 0 };
+#endif
 
 	/// @brief Whether the scheduler is initialized
 	bool isInitialized = false;
@@ -78,6 +165,33 @@ class Scheduler
 		return nextUpdate;
 	}
 
+	/// @brief Link a task into a timing wheel slot
+	void LinkTask(size_t index, uint32_t tick)
+	{
+		uint8_t slot      = tick & WheelMask;
+		wheelSlots[index] = slot;
+		wheelNext[index]  = wheel[slot];
+		wheel[slot]       = index;
+	}
+
+	/// @brief Unlink a task from the timing wheel slot it is in
+	void UnlinkTask(size_t index)
+	{
+		uint8_t* link = &wheel[wheelSlots[index]];
+		while (*link != EndOfList)
+		{
+			if (*link == index)
+			{
+				*link = wheelNext[index];
+				break;
+			}
+
+			link = &wheelNext[*link];
+		}
+
+		wheelNext[index] = EndOfList;
+	}
+
 	static constexpr uint32_t GetFirstUpdate(uint32_t counter, uint32_t interval, uint32_t startOffset)
 	{
 		if (startOffset > counter)
@@ -86,6 +200,30 @@ class Scheduler
 		return counter + interval - (counter - startOffset) % interval;
 	}
 
+	/// @brief Queue or drop the tasks linked into the wheel slot for the current counter value
+	void ProcessTick() __attribute__((section(".RamFunc")));
+
+	/// @brief Run an interrupt task in the timer interrupt and check it against its budget
+	void RunInterruptTask(size_t index) __attribute__((section(".RamFunc")));
+
+	/**
+	 * @brief Get the time in core clock cycles for execution times and statistics
+	 * @remark Reads the cycle counter where there is one, otherwise counts the scheduler timer periods and adds `CNT`
+	 */
+	uint32_t GetTimestamp() const __attribute__((section(".RamFunc")));
+
+	/// @brief Add a task of either class to the first empty slot
+	size_t InsertTask(const InplaceFunction<void()>& task, uint32_t interval, uint32_t startOffset, bool enabled, bool inInterrupt, uint32_t budget);
+
+	/// @brief Get the number of ticks from `counter` until the earliest enabled task is due, at most `maxPeriodTicks`
+	uint32_t GetTicksToNextUpdate() const;
+
+	/// @brief Program the timer period to end at the earliest deadline, called at the start of a period
+	void ArmNextUpdate();
+
+	/// @brief Shorten the current timer period if a task became due before it ends, in tickless mode
+	void Reschedule();
+
   public:
 	/**
 	 * @brief Construct a new Scheduler object
@@ -94,13 +232,16 @@ class Scheduler
 	 * @param frequency The tick frequency of the scheduler
 	 * @param precision The ARR precision for the timer
 	 * @param rollOver The number of ticks before the scheduler rolls over
+	 * @param tickless Whether to only interrupt when a task is due instead of on every tick.
+	 * The timer period is reprogrammed to end at the earliest deadline, so the core can sleep between tasks
 	 */
 	Scheduler(
 		TIM_TypeDef* tim,
 		uint32_t frequency,
 		uint32_t precision = 32,
-		uint32_t rollOver  = std::numeric_limits<uint32_t>::max() / 2)
-		: tim(tim), frequency(frequency), timerPrecision(precision), timerRollOver(rollOver)
+		uint32_t rollOver  = std::numeric_limits<uint32_t>::max() / 2,
+		bool tickless      = false)
+		: tim(tim), frequency(frequency), timerPrecision(precision), timerRollOver(rollOver), tickless(tickless)
 	{}
 
 	/**
@@ -124,24 +265,32 @@ class Scheduler
 	 */
 	uint32_t GetRollOverValue() const { return timerRollOver; }
 
+	/**
+	 * @brief Get whether the scheduler only interrupts when a task is due
+	 *
+	 * @return `bool` Whether the scheduler is in tickless mode
+	 */
+	bool IsTickless() const { return tickless; }
+
 	/**
 	 * @brief Get the current value of the internal counter
+	 * @remark In tickless mode the ticks elapsed in the current timer period are included
 	 *
 	 * @return `uint32_t` The current value of the internal counter
 	 */
-	uint32_t GetCounter() const { return counter; }
+	uint32_t GetCounter() const;
 
 	/**
 	 * @brief Initialize the scheduler
 	 * @remark This function must be called before adding tasks
 	 *
-	 * @return `bool` Whether the scheduler was initialized successfully, or is already initialized
+	 * @return `Status` Success if the scheduler was initialized or is already initialized, converts to `true` on success
 	 */
-	bool Init();
+	Status Init();
 
 	/**
 	 * @brief Update the scheduler, adding tasks to the interrupt queue when they are due
-	 * @remark This function should be called in the timer interrupt
+	 * @remark This function should be called in the timer update interrupt, after clearing the update flag
 	 */
 	void Update() __attribute__((section(".RamFunc")));
 
@@ -154,7 +303,10 @@ class Scheduler
 	 * @param enabled Whether the task is enabled
 	 * @return `size_t` The index of the task in the scheduler, returns `std::numeric_limits<size_t>::max()` if the task could not be added
 	 */
-	size_t AddTask(const std::function<void()>& task, uint32_t interval, uint32_t startOffset = 0, bool enabled = true);
+	size_t AddTask(const InplaceFunction<void()>& task, uint32_t interval, uint32_t startOffset = 0, bool enabled = true)
+	{
+		return InsertTask(task, interval, startOffset, enabled, false, 0);
+	}
 
 	/**
 	 * @brief Add a task to the scheduler
@@ -165,11 +317,29 @@ class Scheduler
 	 * @param enabled Whether the task is enabled
 	 * @return `size_t` The index of the task in the scheduler, returns `std::numeric_limits<size_t>::max()` if the task could not be added
 	 */
-	size_t AddTask(const std::function<void()>& task, float interval, float startOffset = 0, bool enabled = true)
+	size_t AddTask(const InplaceFunction<void()>& task, float interval, float startOffset = 0, bool enabled = true)
 	{
 		return AddTask(task, static_cast<uint32_t>(interval * frequency), static_cast<uint32_t>(startOffset * frequency), enabled);
 	}
 
+	/**
+	 * @brief Add a task that runs directly in the timer interrupt
+	 * @remark Interrupt tasks are never delayed by the interrupt queue or skipped when it is full, use them for control loops.
+	 * They must be short, every run is timed with the cycle counter, or the scheduler timer on cores without one, and counted as an overrun if it takes longer than `budget`.
+	 * An overrunning task is not stopped, check `GetOverrunCount` to detect it
+	 *
+	 * @param task The function to call when the task is due
+	 * @param interval The interval in ticks at which to run the task. Zero indicates a one-shot task
+	 * @param budget The worst case execution time allowed for the task in core clock cycles
+	 * @param startOffset The offset from zero at which the task will start to run
+	 * @param enabled Whether the task is enabled
+	 * @return `size_t` The index of the task in the scheduler, returns `std::numeric_limits<size_t>::max()` if the task could not be added
+	 */
+	size_t AddInterruptTask(const InplaceFunction<void()>& task, uint32_t interval, uint32_t budget, uint32_t startOffset = 0, bool enabled = true)
+	{
+		return InsertTask(task, interval, startOffset, enabled, true, budget);
+	}
+
 	/**
 	 * @brief Removes a task from the scheduler
 	 *
@@ -180,16 +350,10 @@ class Scheduler
 
 	/**
 	 * @brief Enable a task
-	 * @remark Does nothing if the task is already enabled, or an empty slot
+	 * @remark Does nothing if the task is already enabled, or an empty slot. A task whose tick passed while it was disabled runs on the next tick if it is still within the late window
 	 * @param index The index of the task to enable
 	 */
-	void EnableTask(size_t index)
-	{
-		if (index >= MaxTasks)
-			return;
-
-		enabledTasks[index] = true;
-	}
+	void EnableTask(size_t index);
 
 	/**
 	 * @brief Disable a task
@@ -246,6 +410,48 @@ class Scheduler
 		return intervals[index];
 	}
 
+	/**
+	 * @brief Get whether a task runs directly in the timer interrupt
+	 *
+	 * @param index The index of the task
+	 * @return `bool` Whether the task is an interrupt task, returns false if the slot is empty
+	 */
+	bool IsInterruptTask(size_t index) const
+	{
+		if (index >= MaxTasks)
+			return false;
+
+		return interruptTasks[index];
+	}
+
+	/**
+	 * @brief Get the longest measured execution time of an interrupt task
+	 *
+	 * @param index The index of the task
+	 * @return `uint32_t` The execution time in core clock cycles, returns 0 for deferred tasks
+	 */
+	uint32_t GetWorstExecutionTime(size_t index) const
+	{
+		if (index >= MaxTasks)
+			return 0;
+
+		return worstExecutionTimes[index];
+	}
+
+	/**
+	 * @brief Get the number of times an interrupt task ran over its budget
+	 *
+	 * @param index The index of the task
+	 * @return `uint32_t` The number of overruns, returns 0 for deferred tasks
+	 */
+	uint32_t GetOverrunCount(size_t index) const
+	{
+		if (index >= MaxTasks)
+			return 0;
+
+		return overruns[index];
+	}
+
 	/**
 	 * @brief Get whether the scheduler is paused
 	 *
@@ -256,19 +462,43 @@ class Scheduler
 	/**
 	 * @brief Pause the scheduler
 	 */
-	void Pause() { paused = true; }
+	void Pause() { SetPaused(true); }
 
 	/**
 	 * @brief Resume the scheduler
 	 */
-	void Resume() { paused = false; }
+	void Resume() { SetPaused(false); }
 
 	/**
 	 * @brief Set the paused state of the scheduler
+	 * @remark In tickless mode the timer is stopped while paused, so no ticks are lost
 	 *
 	 * @param paused Whether the scheduler should be paused
 	 */
-	void SetPaused(bool paused) { this->paused = paused; }
+	void SetPaused(bool paused)
+	{
+		this->paused = paused;
+
+		if (tickless && isInitialized)
+		{
+			modifyRegister(tim, Tim::CR1::CEN::Of(paused ? 0 : 1));
+		}
+	}
+
+#ifdef SCHEDULER_STATISTICS
+	/**
+	 * @brief Copy the runtime counters of every task
+	 * @remark The copy is made with interrupts disabled, so all counters are from the same instant
+	 *
+	 * @param statistics The array to copy the counters into, indexed by task id
+	 */
+	void GetStatistics(Statistics& statistics) const;
+
+	/**
+	 * @brief Reset the runtime counters of every task
+	 */
+	void ResetStatistics();
+#endif
 };
 
 } // namespace PSR
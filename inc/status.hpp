@@ -0,0 +1,293 @@
+/**
+ * @file status.hpp
+ * @author Purdue Solar Racing
+ * @brief Compact error codes, and status and result types that carry them without using the heap
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace PSR
+{
+
+/// @brief The part of the system an error code belongs to, the upper 16 bits of the code
+enum class Subsystem : uint16_t
+{
+	General        = 0,
+	Scheduler      = 1,
+	InterruptQueue = 2,
+	Counter        = 3,
+	Uart           = 4,
+	Can            = 5,
+
+	/// @brief The first subsystem number free for applications
+	Application = 0x100,
+};
+
+/**
+ * @brief A 32-bit error code made of a subsystem and a code within it
+ * @remark Zero means no error, codes within a subsystem start at 1. Text is only looked up in `ErrorRegistry` when a code is printed
+ */
+class ErrorCode
+{
+  private:
+	uint32_t value;
+
+  public:
+	constexpr ErrorCode() : value(0) {}
+	constexpr ErrorCode(Subsystem subsystem, uint16_t code) : value(((uint32_t)subsystem << 16) | code) {}
+
+	/**
+	 * @brief Create an error code from its raw value, for example one read back from a log
+	 */
+	static constexpr ErrorCode FromValue(uint32_t value)
+	{
+		return ErrorCode((Subsystem)(value >> 16), (uint16_t)value);
+	}
+
+	constexpr uint32_t GetValue() const { return value; }
+	constexpr Subsystem GetSubsystem() const { return (Subsystem)(value >> 16); }
+	constexpr uint16_t GetCode() const { return (uint16_t)value; }
+
+	/// @brief Whether this is an error
+	constexpr explicit operator bool() const { return value != 0; }
+
+	constexpr bool operator==(const ErrorCode& other) const { return value == other.value; }
+	constexpr bool operator!=(const ErrorCode& other) const { return value != other.value; }
+};
+
+/// @brief The error codes reported by the library, their text is in `status.cpp`
+namespace Errors
+{
+
+constexpr ErrorCode None {};
+constexpr ErrorCode MissingValue { Subsystem::General, 1 };
+
+constexpr ErrorCode SchedulerInvalidConfiguration { Subsystem::Scheduler, 1 };
+constexpr ErrorCode SchedulerPrecisionTooHigh { Subsystem::Scheduler, 2 };
+
+constexpr ErrorCode UartBusy { Subsystem::Uart, 1 };
+constexpr ErrorCode UartTimeout { Subsystem::Uart, 2 };
+constexpr ErrorCode UartNotCircular { Subsystem::Uart, 3 };
+
+} // namespace Errors
+
+/// @brief Maps error codes to text, only used when errors are printed
+class ErrorRegistry
+{
+  public:
+	/// @brief The maximum number of application subsystems that can be registered
+	static constexpr size_t MaxSubsystems = 16;
+
+	/// @brief The names and code descriptions of one subsystem
+	struct Entry
+	{
+		Subsystem Id;
+		const char* Name;
+		/// @brief The description of code `i + 1` is at index `i`
+		const char* const* Descriptions;
+		size_t Count;
+	};
+
+  private:
+	static Entry entries[MaxSubsystems];
+	static size_t count;
+
+	static const Entry* Find(Subsystem id);
+
+  public:
+	/**
+	 * @brief Register the text of an application subsystem
+	 * @remark The strings are not copied and must stay valid
+	 *
+	 * @param id The subsystem, `Subsystem::Application` or above
+	 * @param name The name printed before each description
+	 * @param descriptions The description of each code, starting at code 1
+	 * @param count The number of descriptions
+	 * @return `bool` Whether there was room for the subsystem
+	 */
+	static bool Register(Subsystem id, const char* name, const char* const* descriptions, size_t count);
+
+	/**
+	 * @brief Write the text of an error code, `Name: Description`, or the raw numbers if it is not registered
+	 *
+	 * @param code The error code
+	 * @param buffer The buffer to write to, always null terminated
+	 * @param size The size of the buffer
+	 * @return `size_t` The length of the text, truncated to fit the buffer
+	 */
+	static size_t Describe(ErrorCode code, char* buffer, size_t size);
+};
+
+/**
+ * @brief The outcome of an operation, either success or a chain of error codes
+ * @remark The chain is stored inline, innermost first, so a status is cheap to return and checking it is a single compare.
+ * Wrapping more than `MaxDepth` codes drops the ones just outside the root cause
+ */
+class Status
+{
+  public:
+	static constexpr size_t MaxDepth = 4;
+
+  private:
+	ErrorCode codes[MaxDepth];
+	uint8_t depth;
+	bool truncated;
+
+  public:
+	constexpr Status() : codes {}, depth(0), truncated(false) {}
+	constexpr Status(ErrorCode code) : codes { code }, depth(code ? 1 : 0), truncated(false) {}
+
+	static constexpr Status Ok() { return Status(); }
+
+	constexpr bool IsOk() const { return depth == 0; }
+
+	/// @brief Whether the operation succeeded
+	constexpr explicit operator bool() const { return IsOk(); }
+
+	/// @brief Get the outermost error code, `Errors::None` on success
+	constexpr ErrorCode GetCode() const { return depth == 0 ? Errors::None : codes[depth - 1]; }
+
+	/// @brief Get the innermost error code, `Errors::None` on success
+	constexpr ErrorCode GetRootCause() const { return codes[0]; }
+
+	/// @brief Get the number of codes in the chain
+	constexpr size_t GetDepth() const { return depth; }
+
+	/// @brief Get a code in the chain, index 0 is the root cause
+	constexpr ErrorCode GetCode(size_t index) const { return index < depth ? codes[index] : Errors::None; }
+
+	/// @brief Whether codes were dropped from the chain because it was full
+	constexpr bool IsTruncated() const { return truncated; }
+
+	/**
+	 * @brief Add context to an error, does nothing on success
+	 *
+	 * @param code The outer error code
+	 * @return `Status&` This status
+	 */
+	constexpr Status& Wrap(ErrorCode code)
+	{
+		if (depth == 0 || !code)
+			return *this;
+
+		if (depth == MaxDepth)
+		{
+			for (size_t i = 1; i < MaxDepth - 1; i++)
+				codes[i] = codes[i + 1];
+
+			depth--;
+			truncated = true;
+		}
+
+		codes[depth++] = code;
+		return *this;
+	}
+
+	/**
+	 * @brief Write the chain as nested text, the same way `ErrorMessage` renders it
+	 *
+	 * @param buffer The buffer to write to, always null terminated
+	 * @param size The size of the buffer
+	 * @return `size_t` The length of the text, truncated to fit the buffer
+	 */
+	size_t WriteMessage(char* buffer, size_t size) const;
+
+	/**
+	 * @brief Make this the current `ErrorMessage`, the codes are only turned into text when it is printed
+	 */
+	void Report() const;
+};
+
+/**
+ * @brief Either a value or the status of the error that prevented it
+ * @remark The value is stored inline and only constructed on success
+ *
+ * @tparam T The value type
+ */
+template <typename T>
+class Result
+{
+  private:
+	Status status;
+	union
+	{
+		T value;
+	};
+
+  public:
+	Result(const T& value) : status(), value(value) {}
+	Result(T&& value) : status(), value(std::move(value)) {}
+
+	/// @brief Create a failed result, a successful status becomes `Errors::MissingValue`
+	Result(const Status& status) : status(status.IsOk() ? Status(Errors::MissingValue) : status) {}
+	Result(ErrorCode code) : Result(Status(code)) {}
+
+	Result(const Result& other) : status(other.status)
+	{
+		if (status.IsOk())
+			new (&value) T(other.value);
+	}
+
+	Result(Result&& other) : status(other.status)
+	{
+		if (status.IsOk())
+			new (&value) T(std::move(other.value));
+	}
+
+	Result& operator=(const Result& other)
+	{
+		if (this != &other)
+		{
+			this->~Result();
+			new (this) Result(other);
+		}
+
+		return *this;
+	}
+
+	Result& operator=(Result&& other)
+	{
+		if (this != &other)
+		{
+			this->~Result();
+			new (this) Result(std::move(other));
+		}
+
+		return *this;
+	}
+
+	~Result()
+	{
+		if (status.IsOk())
+			value.~T();
+	}
+
+	bool IsOk() const { return status.IsOk(); }
+
+	/// @brief Whether there is a value
+	explicit operator bool() const { return IsOk(); }
+
+	const Status& GetStatus() const { return status; }
+
+	/// @brief Get the value, must only be called on success
+	T& GetValue() { return value; }
+	const T& GetValue() const { return value; }
+
+	/// @brief Get the value, or a fallback on error
+	T GetValueOr(const T& fallback) const { return IsOk() ? value : fallback; }
+
+	T& operator*() { return value; }
+	const T& operator*() const { return value; }
+	T* operator->() { return &value; }
+	const T* operator->() const { return &value; }
+};
+
+} // namespace PSR
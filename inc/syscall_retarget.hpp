@@ -10,13 +10,153 @@
 #define CURSOR_UP(n) "\e[" #n "A"
 #define CURSOR_DOWN(n) "\e[" #n "B"
 
+/// @brief The size of the transmit ring used by `SyscallUARTRetargetBuffered`, must be a power of two
+#ifndef SYSCALL_TX_BUFFER_SIZE
+#define SYSCALL_TX_BUFFER_SIZE 1024
+#endif
+
+/// @brief The size of the circular DMA buffer used by `SyscallUARTStartReceive`, must be a power of two
+#ifndef SYSCALL_RX_BUFFER_SIZE
+#define SYSCALL_RX_BUFFER_SIZE 256
+#endif
+
 #ifdef __cplusplus
+#include "status.hpp"
 #include <functional>
 #include <cstdio>
 
 void SyscallUARTRetarget(UART_HandleTypeDef* huart, uint32_t timeout, std::function<void()> onTxStart, std::function<void()> onTxEnd);
 
+/// @brief How the transmit ring is sent to the UART
+enum class TxDrainMode : uint8_t
+{
+	DMA,       ///< @brief `HAL_UART_Transmit_DMA`
+	Interrupt, ///< @brief `HAL_UART_Transmit_IT`, for UARTs without a DMA channel
+};
+
+/// @brief What `_write` does with bytes that do not fit in the transmit ring
+enum class TxFullPolicy : uint8_t
+{
+	Drop,      ///< @brief Drop the new bytes that do not fit
+	Overwrite, ///< @brief Discard the oldest queued bytes that are not yet being sent, only as many as the new ones need
+	Block,     ///< @brief Wait for room up to the timeout, drops instead when called from an interrupt or with interrupts disabled
+};
+
+/// @brief Counters of the buffered `stdout`
+struct UARTTxStatistics
+{
+	uint32_t Written;       ///< @brief Bytes accepted into the ring
+	uint32_t Dropped;       ///< @brief Bytes dropped or overwritten because the ring was full
+	uint32_t HighWatermark; ///< @brief The most bytes ever waiting in the ring
+	uint32_t Bursts;        ///< @brief DMA or interrupt transfers started
+};
+
+/**
+ * @brief Retarget `stdout` and `stderr` to a UART through a transmit ring, so `printf` returns without waiting for the line
+ * @remark `SyscallUARTTxComplete` must be called from `HAL_UART_TxCpltCallback`. Each transfer sends the contiguous queued bytes,
+ * `onTxStart` is called right before it starts and `onTxEnd` once it finishes, both with interrupts disabled or from the interrupt.
+ * `stdin` keeps using blocking receives
+ *
+ * @param huart The UART handle
+ * @param timeout The timeout for `stdin` reads and for waiting for room with `TxFullPolicy::Block`, in milliseconds
+ * @param mode How the ring is sent to the UART
+ * @param policy What to do when the ring is full
+ * @param onTxStart Called before each transfer, for example to enable an RS-485 driver
+ * @param onTxEnd Called after each transfer
+ */
+void SyscallUARTRetargetBuffered(UART_HandleTypeDef* huart, uint32_t timeout, TxDrainMode mode, TxFullPolicy policy, std::function<void()> onTxStart, std::function<void()> onTxEnd);
+
+/**
+ * @brief Start sending the next queued bytes, call from `HAL_UART_TxCpltCallback`
+ *
+ * @param huart The UART whose transfer finished, ignored if it is not the `stdout` UART
+ */
+void SyscallUARTTxComplete(UART_HandleTypeDef* huart);
+
+/**
+ * @brief Get the counters of the buffered `stdout`
+ */
+UARTTxStatistics GetUARTTxStatistics();
+
+/**
+ * @brief Wait until every queued byte has been sent
+ *
+ * @param timeout The maximum time to wait in milliseconds
+ * @return `bool` Whether the ring emptied in time
+ */
+bool SyscallUARTFlush(uint32_t timeout);
+
+/// @brief Counters of the buffered `stdin`
+struct UARTRxStatistics
+{
+	uint32_t Received; ///< @brief Bytes written to the buffer by the DMA
+	uint32_t Overrun;  ///< @brief Bytes overwritten by the DMA before they were consumed
+	uint32_t Events;   ///< @brief Half, full and idle line events
+	uint32_t Restarts; ///< @brief Receptions restarted after a UART error
+};
+
+/**
+ * @brief Receive `stdin` continuously into a circular DMA buffer with idle line detection
+ * @remark The receive DMA stream must be set up in circular mode. `SyscallUARTRxEvent` must be called from `HAL_UARTEx_RxEventCallback`
+ * and `SyscallUARTRxError` from `HAL_UART_ErrorCallback`. Bytes arriving while nobody is reading are kept until the buffer wraps around,
+ * and `_read` returns the bytes that are available as soon as there is at least one, waiting at most the retarget timeout
+ *
+ * @param huart The UART handle
+ * @return `Status` Whether reception started, `Errors::UartNotCircular` or `Errors::UartBusy` if it did not
+ */
+PSR::Status SyscallUARTStartReceive(UART_HandleTypeDef* huart);
+
+/**
+ * @brief Make newly received bytes available, call from `HAL_UARTEx_RxEventCallback`
+ *
+ * @param huart The UART that raised the event, ignored if it is not the `stdin` UART
+ * @param size The DMA position in the buffer reported by the event
+ */
+void SyscallUARTRxEvent(UART_HandleTypeDef* huart, uint16_t size);
+
+/**
+ * @brief Restart reception after an error aborted it, call from `HAL_UART_ErrorCallback`
+ * @remark Bytes that were not consumed yet are dropped and counted as overrun
+ *
+ * @param huart The UART that raised the error, ignored if it is not the `stdin` UART
+ */
+void SyscallUARTRxError(UART_HandleTypeDef* huart);
+
+/**
+ * @brief Get the number of received bytes that have not been consumed
+ */
+size_t SyscallUARTAvailable();
+
+/**
+ * @brief Get the oldest received bytes without copying them out of the DMA buffer
+ * @remark Returns only the part up to the end of the buffer, peek again after consuming it to get the wrapped part.
+ * Must only be called from one context, and the bytes stay valid until they are consumed
+ * unless the sender gets a whole buffer ahead
+ *
+ * @param data Set to the first unconsumed byte
+ * @return `size_t` The number of contiguous bytes at `data`
+ */
+size_t SyscallUARTPeek(const uint8_t** data);
+
+/**
+ * @brief Release received bytes so the DMA can reuse their space
+ *
+ * @param count The number of bytes to release, at most the number available
+ */
+void SyscallUARTConsume(size_t count);
+
+/**
+ * @brief Get the counters of the buffered `stdin`
+ */
+UARTRxStatistics GetUARTRxStatistics();
+
 // Debug print
+#if defined(PRINT_DEBUG) && defined(DEFERRED_LOGGING)
+#include "deferred_log.hpp"
+
+// Store a binary record instead of formatting, the format must be a string literal
+#define print_debug(format, ...) DEFERRED_LOG(format, ##__VA_ARGS__)
+#else
 #pragma GCC push_options
 #pragma GCC optimize("O3")
 template <typename... Args>
@@ -24,9 +164,13 @@ __attribute__((always_inline)) static inline void print_debug(const char* str, A
 {
 #ifdef PRINT_DEBUG
 	printf(str, args...);
+#else
+	(void)str;
+	((void)args, ...);
 #endif
 }
 #pragma GCC pop_options
+#endif
 
 extern "C"
 {
@@ -0,0 +1,83 @@
+/**
+ * @file timer_registers.hpp
+ * @author Purdue Solar Racing
+ * @brief Typed fields of the general purpose timer registers used by the library
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+
+#include "register_field.hpp"
+
+#include "stm32_includer.h"
+#include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
+#include STM32_INCLUDE(STM32_PROCESSOR, hal_def.h)
+
+namespace PSR
+{
+
+/// @brief General purpose timer registers, only the fields that are in the same place on every STM32 family
+namespace Tim
+{
+
+namespace CR1
+{
+using Register = PSR::Register<TIM_TypeDef, &TIM_TypeDef::CR1>;
+
+using CEN  = Field<Register, 0, 1>; ///< @brief Counter enable
+using UDIS = Field<Register, 1, 1>; ///< @brief Update disable
+using URS  = Field<Register, 2, 1>; ///< @brief Only counter overflow raises an update interrupt
+using OPM  = Field<Register, 3, 1>; ///< @brief One pulse mode
+using DIR  = Field<Register, 4, 1>; ///< @brief Count down
+using CMS  = Field<Register, 5, 2>; ///< @brief Center aligned mode
+using ARPE = Field<Register, 7, 1>; ///< @brief Auto reload preload enable
+using CKD  = Field<Register, 8, 2>; ///< @brief Dead time and filter clock division
+} // namespace CR1
+
+namespace CR2
+{
+using Register = PSR::Register<TIM_TypeDef, &TIM_TypeDef::CR2>;
+
+using MMS = Field<Register, 4, 3>; ///< @brief Master mode, what drives TRGO
+} // namespace CR2
+
+namespace DIER
+{
+using Register = PSR::Register<TIM_TypeDef, &TIM_TypeDef::DIER>;
+
+using UIE   = Field<Register, 0, 1>; ///< @brief Update interrupt enable
+using CC1IE = Field<Register, 1, 1>; ///< @brief Capture compare 1 interrupt enable
+using CC2IE = Field<Register, 2, 1>; ///< @brief Capture compare 2 interrupt enable
+using CC3IE = Field<Register, 3, 1>; ///< @brief Capture compare 3 interrupt enable
+using CC4IE = Field<Register, 4, 1>; ///< @brief Capture compare 4 interrupt enable
+} // namespace DIER
+
+/// @brief Status flags, cleared by writing zero, use `clearRegisterFlags`
+namespace SR
+{
+using Register = PSR::Register<TIM_TypeDef, &TIM_TypeDef::SR>;
+
+using UIF   = Field<Register, 0, 1>; ///< @brief Update interrupt flag
+using CC1IF = Field<Register, 1, 1>; ///< @brief Capture compare 1 interrupt flag
+using CC2IF = Field<Register, 2, 1>; ///< @brief Capture compare 2 interrupt flag
+using CC3IF = Field<Register, 3, 1>; ///< @brief Capture compare 3 interrupt flag
+using CC4IF = Field<Register, 4, 1>; ///< @brief Capture compare 4 interrupt flag
+} // namespace SR
+
+/// @brief Event generation, write only
+namespace EGR
+{
+using Register = PSR::Register<TIM_TypeDef, &TIM_TypeDef::EGR>;
+
+using UG   = Field<Register, 0, 1>; ///< @brief Generate an update event
+using CC1G = Field<Register, 1, 1>; ///< @brief Generate a capture compare 1 event
+using CC2G = Field<Register, 2, 1>; ///< @brief Generate a capture compare 2 event
+using CC3G = Field<Register, 3, 1>; ///< @brief Generate a capture compare 3 event
+using CC4G = Field<Register, 4, 1>; ///< @brief Generate a capture compare 4 event
+} // namespace EGR
+
+} // namespace Tim
+
+} // namespace PSR
@@ -0,0 +1,87 @@
+/**
+ * @file deferred_log.cpp
+ * @author Purdue Solar Racing
+ * @brief Binary logging that defers formatting to a host side decoder
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "deferred_log.hpp"
+#include "atomic_operations.hpp"
+
+#include <cstdio>
+
+using namespace PSR;
+
+// Zeroed words are never mistaken for a published header
+std::array<std::atomic<uint32_t>, DeferredLog::CapacityWords> DeferredLog::ring;
+std::atomic<uint32_t> DeferredLog::head    = 0;
+std::atomic<uint32_t> DeferredLog::tail    = 0;
+std::atomic<uint32_t> DeferredLog::dropped = 0;
+DeferredLog::Sink DeferredLog::sink        = nullptr;
+
+bool DeferredLog::Commit(uint32_t* record, size_t length)
+{
+	uint32_t position = head.load(std::memory_order_relaxed);
+	do
+	{
+		if (position + length - tail.load(std::memory_order_acquire) > CapacityWords)
+		{
+			atomicFetchAdd(dropped, 1, std::memory_order_relaxed);
+			return false;
+		}
+	} while (!atomicCompareExchange(head, position, position + length, std::memory_order_relaxed));
+
+	for (size_t i = 1; i < length; i++)
+		ring[(position + i) % CapacityWords].store(record[i], std::memory_order_relaxed);
+
+	// The header is stored last, the drain stops at a record until it is set
+	ring[position % CapacityWords].store(Magic | length, std::memory_order_release);
+
+	return true;
+}
+
+void DeferredLog::SetSink(const Sink& newSink)
+{
+	sink = newSink;
+}
+
+size_t DeferredLog::Drain(size_t maxRecords)
+{
+	uint32_t record[MaxRecordWords];
+	uint32_t position = tail.load(std::memory_order_relaxed);
+
+	size_t drained = 0;
+	for (; drained < maxRecords; drained++)
+	{
+		uint32_t header = ring[position % CapacityWords].load(std::memory_order_acquire);
+		if ((header & MagicMask) != Magic)
+			break;
+
+		size_t length = header & ~MagicMask;
+		if (length < HeaderWords || length > MaxRecordWords)
+			break;
+
+		for (size_t i = 0; i < length; i++)
+		{
+			// Clear the words so a later record's body is never mistaken for a header
+			std::atomic<uint32_t>& word = ring[(position + i) % CapacityWords];
+			record[i]                   = word.load(std::memory_order_relaxed);
+			word.store(0, std::memory_order_relaxed);
+		}
+
+		position += length;
+		tail.store(position, std::memory_order_release);
+
+		if (sink)
+			sink((const uint8_t*)record, length * sizeof(uint32_t));
+		else
+			fwrite(record, sizeof(uint32_t), length, stdout);
+	}
+
+	if (sink == nullptr && drained > 0)
+		fflush(stdout);
+
+	return drained;
+}
@@ -1,81 +1,243 @@
 #include "errors.hpp"
+#include "critical_section.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
 
 using namespace PSR;
 
 using Error = ErrorMessage::Error;
 
-std::shared_ptr<Error> ErrorMessage::error = nullptr;
+Error ErrorMessage::errors[MaxErrors];
+size_t ErrorMessage::depth                                      = 0;
+bool ErrorMessage::truncated                                    = false;
+char ErrorMessage::renderBuffer[ErrorMessage::RenderBufferSize] = {};
+
+static constexpr const char* TruncatedMessage = "More inner errors...";
+
+Error& ErrorMessage::Push()
+{
+	if (depth == MaxErrors)
+	{
+		// Keep the root cause and the outermost context, drop the message just outside the root cause
+		memmove(&errors[1], &errors[2], (MaxErrors - 2) * sizeof(Error));
+		depth--;
+		truncated = true;
+	}
+
+	return errors[depth++];
+}
+
+Error& ErrorMessage::Reset()
+{
+	depth     = 0;
+	truncated = false;
+	return Push();
+}
 
 void ErrorMessage::ClearMessage()
 {
-	if (error != nullptr)
-		error = nullptr;
+	uint32_t primask = EnterCriticalSection();
+	depth            = 0;
+	truncated        = false;
+	ExitCriticalSection(primask);
 }
 
-size_t ErrorMessage::GetRequiredMessageSize(const std::shared_ptr<Error>& error, size_t depth)
+static size_t AppendLine(char* buffer, size_t size, size_t length, size_t tabs, const char* message)
 {
-	size_t size = depth + strlen(error->Message.get()) + 1; // +depth for tabs, +1 for newline
+	for (size_t i = 0; i < tabs && length + 1 < size; i++)
+		buffer[length++] = '\t';
+
+	size_t messageLength = strlen(message);
+	if (messageLength > size - 1 - length)
+		messageLength = size - 1 - length;
+
+	memcpy(&buffer[length], message, messageLength);
+	length += messageLength;
 
-	if (error->InnerError != nullptr)
-		size += GetRequiredMessageSize(error->InnerError, depth + 1);
+	if (length + 1 < size)
+		buffer[length++] = '\n';
 
-	return size + 1; // +1 for null terminator
+	buffer[length] = '\0';
+	return length;
 }
 
-static char* WriteInnerErrorsInternal(const std::shared_ptr<Error>& error, char* buffer, size_t depth = 0)
+/**
+ * @brief Write nested messages, the outermost first and each inner one indented by one more tab
+ *
+ * @param count The number of messages
+ * @param truncated Whether messages were dropped just outside the innermost one
+ * @param write Writes the text of message `i`, counted from the innermost, into a line buffer and returns it
+ */
+template <typename WriteLine>
+static size_t WriteNested(char* buffer, size_t size, size_t count, bool truncated, WriteLine write)
 {
-	size_t messageLen = strlen(error->Message.get());
-	for (size_t i = 0; i < depth; i++)
-		*(buffer++) = '\t';
+	if (buffer == nullptr || size == 0)
+		return 0;
 
-	memcpy(buffer, error->Message.get(), messageLen);
-	buffer += messageLen;
-	*(buffer++) = '\n';
+	buffer[0] = '\0';
 
-	if (error->InnerError != nullptr)
-		buffer = WriteInnerErrorsInternal(error->InnerError, buffer, depth + 1);
-	else
-		*(buffer++) = '\0';
+	char line[ErrorMessage::MaxMessageLength];
+	size_t length = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		bool innermost = i == count - 1;
+		if (truncated && innermost)
+			length = AppendLine(buffer, size, length, i, TruncatedMessage);
+
+		length = AppendLine(buffer, size, length, i + (truncated && innermost), write(count - 1 - i, line));
+	}
 
-	return buffer;
+	return length;
 }
 
-std::shared_ptr<char[]> ErrorMessage::WriteInnerErrors(const std::shared_ptr<Error>& error)
+size_t ErrorMessage::WriteMessage(char* buffer, size_t size)
 {
-	if (error == nullptr)
-		return nullptr;
+	// Copy the messages out and render them with interrupts enabled, describing codes and formatting can take a while
+	Error snapshot[MaxErrors];
+
+	uint32_t primask = EnterCriticalSection();
 
-	size_t size = GetRequiredMessageSize(error);
-	std::shared_ptr<char[]> message(new char[size]);
+	size_t count      = depth;
+	bool wasTruncated = truncated;
+	memcpy(snapshot, errors, count * sizeof(Error));
 
-	WriteInnerErrorsInternal(error, message.get());
+	ExitCriticalSection(primask);
 
-	return message;
+	return WriteNested(buffer, size, count, wasTruncated, [&](size_t i, char* line) -> const char* {
+		const Error& error = snapshot[i];
+		if (error.Static != nullptr)
+			return error.Static;
+
+		if (error.Code)
+		{
+			ErrorRegistry::Describe(error.Code, line, MaxMessageLength);
+			return line;
+		}
+
+		return error.Text;
+	});
 }
 
-static void PrintInternal(const std::shared_ptr<Error>& error, size_t depth = 0)
+size_t ErrorMessage::WriteMessage(const Status& status, char* buffer, size_t size)
 {
-	constexpr const char* tabString = "\t\t\t\t\t\t\t\tMore inner errors...";
-	constexpr size_t tabChars       = 8;
-	constexpr size_t takeChars      = 1;
-
-	if (depth >= tabChars / takeChars)
-	{
-		puts(tabString);
-		return;
-	}
+	return WriteNested(buffer, size, status.GetDepth(), status.IsTruncated(), [&](size_t i, char* line) -> const char* {
+		ErrorRegistry::Describe(status.GetCode(i), line, MaxMessageLength);
+		return line;
+	});
+}
 
-	printf("%.*s%s\n", takeChars * depth, tabString, error->Message.get());
+const char* ErrorMessage::GetMessage()
+{
+	if (depth == 0)
+		return EmptyError; // Return empty error message
 
-	if (error->InnerError != nullptr)
-		PrintInternal(error->InnerError, depth + 1);
+	WriteMessage(renderBuffer, sizeof(renderBuffer));
+	return renderBuffer;
 }
 
 void ErrorMessage::PrintMessage()
 {
-	if (error == nullptr)
+	if (depth == 0)
 		return;
 
-	PrintInternal(error);
+	fputs(GetMessage(), stdout);
 	ClearMessage();
-}
\ No newline at end of file
+}
+
+void ErrorMessage::SetMessage(const char* message)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	Error& error = Reset();
+	error.Static = message;
+	error.Code   = Errors::None;
+
+	ExitCriticalSection(primask);
+}
+
+/// @brief Copy a message formatted outside the critical section into an entry, must be called with interrupts disabled
+static void SetText(Error& error, const char* text)
+{
+	error.Static = nullptr;
+	error.Code   = Errors::None;
+	memcpy(error.Text, text, sizeof(error.Text));
+}
+
+void ErrorMessage::SetFormattedMessage(const char* format, ...)
+{
+	char text[MaxMessageLength];
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+
+	uint32_t primask = EnterCriticalSection();
+	SetText(Reset(), text);
+	ExitCriticalSection(primask);
+}
+
+void ErrorMessage::SetMessage(ErrorCode code)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	Error& error = Reset();
+	error.Static = nullptr;
+	error.Code   = code;
+
+	ExitCriticalSection(primask);
+}
+
+void ErrorMessage::SetMessage(const Status& status)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	depth     = 0;
+	truncated = status.IsTruncated();
+	for (size_t i = 0; i < status.GetDepth(); i++)
+	{
+		Error& error = Push();
+		error.Static = nullptr;
+		error.Code   = status.GetCode(i);
+	}
+
+	ExitCriticalSection(primask);
+}
+
+void ErrorMessage::WrapMessage(const char* message)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	Error& error = Push();
+	error.Static = message;
+	error.Code   = Errors::None;
+
+	ExitCriticalSection(primask);
+}
+
+void ErrorMessage::WrapMessage(ErrorCode code)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	Error& error = Push();
+	error.Static = nullptr;
+	error.Code   = code;
+
+	ExitCriticalSection(primask);
+}
+
+void ErrorMessage::WrapFormattedMessage(const char* format, ...)
+{
+	char text[MaxMessageLength];
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+
+	uint32_t primask = EnterCriticalSection();
+	SetText(Push(), text);
+	ExitCriticalSection(primask);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file fault_log.cpp
+ * @author Purdue Solar Racing
+ * @brief Ring of timestamped error records that survives warm resets
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "fault_log.hpp"
+#include "critical_section.h"
+
+#include <cstring>
+
+using namespace PSR;
+
+FaultLog::Storage FaultLog::storage __attribute__((section(".noinit")));
+const HighPrecisionCounter* FaultLog::counter = nullptr;
+
+uint32_t FaultLog::Checksum(const Entry& entry)
+{
+	const uint32_t words[] = {
+		entry.Code,
+		entry.Count | ((uint32_t)entry.Boot << 16),
+		(uint32_t)entry.FirstTime,
+		(uint32_t)(entry.FirstTime >> 32),
+		(uint32_t)entry.LastTime,
+		(uint32_t)(entry.LastTime >> 32),
+	};
+
+	// FNV-1a over the words, random RAM after a power cycle almost never matches
+	uint32_t hash = 2166136261u ^ Magic;
+	for (uint32_t word : words)
+		hash = (hash ^ word) * 16777619u;
+
+	return hash;
+}
+
+void FaultLog::Validate()
+{
+	if (storage.Magic == Magic)
+		return;
+
+	memset(&storage, 0, sizeof(storage));
+	storage.Magic = Magic;
+}
+
+void FaultLog::Init(const HighPrecisionCounter* timeSource)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	Validate();
+	counter = timeSource;
+	storage.Boot++;
+
+	ExitCriticalSection(primask);
+}
+
+void FaultLog::Record(ErrorCode code)
+{
+	if (!code)
+		return;
+
+	uint64_t now = counter != nullptr ? counter->GetCount() : 0;
+
+	uint32_t primask = EnterCriticalSection();
+
+	Validate();
+
+	if (storage.Head > 0)
+	{
+		Entry& last = storage.Entries[(storage.Head - 1) % Capacity];
+		if (last.Code == code.GetValue() && last.Boot == storage.Boot && now - last.LastTime <= CoalesceWindow && last.Check == Checksum(last))
+		{
+			if (last.Count < UINT16_MAX)
+				last.Count++;
+
+			last.LastTime = now;
+			last.Check    = Checksum(last);
+
+			ExitCriticalSection(primask);
+			return;
+		}
+	}
+
+	Entry& entry    = storage.Entries[storage.Head % Capacity];
+	entry.Code      = code.GetValue();
+	entry.Count     = 1;
+	entry.Boot      = storage.Boot;
+	entry.FirstTime = now;
+	entry.LastTime  = now;
+	entry.Check     = Checksum(entry);
+	storage.Head++;
+
+	ExitCriticalSection(primask);
+}
+
+size_t FaultLog::Read(uint32_t& sequence, Entry* entries, size_t maxEntries)
+{
+	size_t count = 0;
+	while (count < maxEntries)
+	{
+		// One record at a time so interrupts are only held off for a short copy
+		uint32_t primask = EnterCriticalSection();
+
+		Validate();
+
+		uint32_t head = storage.Head;
+		if (head - sequence > Capacity)
+			sequence = head > Capacity ? head - Capacity : 0;
+
+		if (sequence == head)
+		{
+			ExitCriticalSection(primask);
+			break;
+		}
+
+		const Entry& entry = storage.Entries[sequence % Capacity];
+		bool valid         = entry.Check == Checksum(entry);
+		if (valid)
+			entries[count++] = entry;
+
+		sequence++;
+
+		ExitCriticalSection(primask);
+	}
+
+	return count;
+}
+
+void FaultLog::Clear()
+{
+	uint32_t primask = EnterCriticalSection();
+
+	memset(&storage, 0, sizeof(storage));
+	storage.Magic = Magic;
+
+	ExitCriticalSection(primask);
+}
@@ -1,5 +1,7 @@
 #include "high_precision_counter.hpp"
+#include "critical_section.h"
 #include "interrupt_queue.hpp"
+#include "profiler.hpp"
 #include "timer_helpers.h"
 
 using namespace PSR;
@@ -9,11 +11,28 @@ void HighPrecisionCounter::Update(uint32_t statusRegister, bool suppressCallback
 	[[unlikely]] if (!this->isInitialized)
 		return;
 
+	PROFILE_ZONE("HighPrecisionCounter::Update");
+
 	if ((statusRegister & TIM_SR_UIF) != 0)
-		this->upperCount += this->timerPrecision;
+	{
+		// Clear the flag and count the period together, GetRawCount relies on seeing exactly one of them
+		uint32_t primask = EnterCriticalSection();
+
+		clearRegisterFlags(this->tim, Tim::SR::UIF::Set);
+		if (this->upperTim == nullptr)
+			this->upperCount = this->upperCount + GetPeriod();
+
+		ExitCriticalSection(primask);
+	}
+
+	if ((statusRegister & TIM_SR_CC1IF) != 0)
+		clearRegisterFlags(this->tim, Tim::SR::CC1IF::Set);
 
 	if (!suppressCallbacks)
+	{
 		this->HandleDelayCallbacks();
+		this->ArmAlarm();
+	}
 }
 
 bool HighPrecisionCounter::Init()
@@ -22,16 +41,45 @@ bool HighPrecisionCounter::Init()
 		return true;
 
 	upperCount         = 0;
+	discipline.Reset();
 	uint32_t clockFreq = GetTimerInputFrequency(tim);
 
-	tim->CR1  = 0;
-	tim->DIER = TIM_DIER_UIE;
-	tim->PSC  = clockFreq / 1000000 - 1;
-	tim->ARR  = timerPrecision - 1;
-	tim->CNT  = 0xFFFFFFFF;
-	tim->CR1 |= TIM_CR1_CEN | TIM_CR1_ARPE;
+	Tim::CR1::Register::ResetRegister(tim);
+	writeRegister(tim, Tim::DIER::UIE::Set);
+	tim->PSC   = clockFreq / 1000000 - 1;
+	tim->ARR   = timerPrecision - 1;
+	tim->CCMR1 = 0; // Channel 1 is a frozen output compare with no preload, used only as an alarm
+	tim->CCER  = 0;
+	tim->CCR1  = 0;
+
+	// The master's update event is its TRGO, which clocks the slave in external clock mode 1
+	if (upperTim != nullptr)
+		tim->CR2 = TIM_TRGO_UPDATE;
+
+	// PSC is only loaded by an update event, so generate one now without an update interrupt.
+	// It also clears the count, and in cascaded mode clocks the slave before the slave is enabled
+	writeRegister(tim, Tim::CR1::URS::Set);
+	writeRegister(tim, Tim::EGR::UG::Set);
+	clearRegisterFlags(tim, Tim::SR::UIF::Set);
+
+	if (upperTim != nullptr)
+	{
+		Tim::CR1::Register::ResetRegister(upperTim);
+		Tim::DIER::Register::ResetRegister(upperTim);
+		upperTim->PSC  = 0;
+		upperTim->ARR  = 0xFFFFFFFF;
+		upperTim->SMCR = triggerSelection | TIM_SLAVEMODE_EXTERNAL1;
+		writeRegister(upperTim, Tim::CR1::URS::Set);
+		writeRegister(upperTim, Tim::EGR::UG::Set);
+		clearRegisterFlags(upperTim, Tim::SR::UIF::Set);
+		writeRegister(upperTim, Tim::CR1::CEN::Set);
+	}
+
+	// CR1 is written without being read back, which also clears URS
+	writeRegister(tim, Tim::CR1::CEN::Set | Tim::CR1::ARPE::Set);
 
 	delayedCallbacks.fill(DelayedCallback());
+	callbackCount = 0;
 
 	isInitialized = true;
 
@@ -41,56 +89,224 @@ bool HighPrecisionCounter::Init()
 void HighPrecisionCounter::HandleDelayCallbacks()
 {
 	uint64_t count = GetCount();
-	for (size_t i = 0; i < highestCallbackIndex; i++)
+	while (callbackCount > 0)
 	{
-		DelayedCallback& delayedCallback = delayedCallbacks[i];
-		if (delayedCallback.Callback != nullptr && delayedCallback.DelayUntil != 0 && count >= delayedCallback.DelayUntil)
-		{
-			// If the interrupt queue is full, try again next time
-			if (!InterruptQueue::AddInterrupt(delayedCallback.Callback))
-				continue;
+		DelayedCallback& delayedCallback = delayedCallbacks[callbackHeap[0]];
+		if (count < delayedCallback.DelayUntil)
+			break; // Nothing else is due yet
 
-			delayedCallback.DelayUntil = 0;
-			delayedCallback.Callback   = nullptr;
+		// If the interrupt queue is full, try again next time
+		if (!InterruptQueue::AddInterrupt(delayedCallback.Callback))
+			break;
 
-			if (i + 1 >= highestCallbackIndex)
-				highestCallbackIndex--;
+		if (delayedCallback.Period != 0)
+		{
+			// Skip any repeats that were missed instead of queueing them all at once
+			uint64_t missed = (count - delayedCallback.DelayUntil) / delayedCallback.Period;
+			delayedCallback.DelayUntil += (missed + 1) * delayedCallback.Period;
+			HeapSiftDown(0);
 		}
+		else
+		{
+			HeapRemove(0);
+			delayedCallback.Callback = nullptr;
+			delayedCallback.Generation++;
+		}
+	}
+}
+
+void HighPrecisionCounter::ArmAlarm()
+{
+	while (callbackCount > 0)
+	{
+		// The compare channel works on the raw hardware count
+		uint64_t deadline = discipline.ToRaw(delayedCallbacks[callbackHeap[0]].DelayUntil);
+		uint64_t now      = GetRawCount();
+		// The count at which the lower timer last rolled over
+		uint64_t windowStart = upperTim != nullptr ? now - (uint32_t)now : (uint64_t)upperCount;
+
+		// Deadlines in a later timer period are armed by the update event that starts it
+		if (deadline >= windowStart + GetPeriod())
+			break;
+
+		tim->CCR1 = deadline > windowStart ? (uint32_t)(deadline - windowStart) : 0;
+		clearRegisterFlags(tim, Tim::SR::CC1IF::Set);
+		modifyRegister(tim, Tim::DIER::CC1IE::Set);
+
+		if (GetRawCount() < deadline)
+			return;
+
+		// The deadline passed before the compare was armed, so handle it now
+		HandleDelayCallbacks();
+
+		// If the interrupt queue is full, try again on the next update event
+		if (callbackCount > 0 && delayedCallbacks[callbackHeap[0]].DelayUntil <= GetCount())
+			break;
 	}
+
+	modifyRegister(tim, Tim::DIER::CC1IE::Clear);
 }
 
 void HighPrecisionCounter::ClearCallbacks()
 {
+	uint32_t primask = EnterCriticalSection();
+
 	for (size_t i = 0; i < delayedCallbacks.size(); i++)
 	{
+		if (delayedCallbacks[i].Callback != nullptr)
+			delayedCallbacks[i].Generation++;
+
 		delayedCallbacks[i].DelayUntil = 0;
+		delayedCallbacks[i].Period     = 0;
 		delayedCallbacks[i].Callback   = nullptr;
 	}
+	callbackCount = 0;
+
+	if (isInitialized)
+		ArmAlarm();
+
+	ExitCriticalSection(primask);
 }
 
-bool HighPrecisionCounter::AddDelayedCallback(uint32_t delay, const std::function<void()>& callback)
+void HighPrecisionCounter::HeapSiftUp(size_t position)
 {
-	if (delay == 0 || callback == nullptr)
-		return false;
+	uint8_t index       = callbackHeap[position];
+	uint64_t delayUntil = delayedCallbacks[index].DelayUntil;
 
-	uint64_t delayUntil = GetCount() + delay * MillesecondsToMicroseconds;
+	while (position > 0)
+	{
+		size_t parent = (position - 1) / 2;
+		if (delayedCallbacks[callbackHeap[parent]].DelayUntil <= delayUntil)
+			break;
+
+		callbackHeap[position]                               = callbackHeap[parent];
+		delayedCallbacks[callbackHeap[position]].HeapIndex = position;
+		position                                             = parent;
+	}
+
+	callbackHeap[position]            = index;
+	delayedCallbacks[index].HeapIndex = position;
+}
+
+void HighPrecisionCounter::HeapSiftDown(size_t position)
+{
+	uint8_t index       = callbackHeap[position];
+	uint64_t delayUntil = delayedCallbacks[index].DelayUntil;
+
+	for (;;)
+	{
+		size_t child = 2 * position + 1;
+		if (child >= callbackCount)
+			break;
+
+		if (child + 1 < callbackCount && delayedCallbacks[callbackHeap[child + 1]].DelayUntil < delayedCallbacks[callbackHeap[child]].DelayUntil)
+			child++;
+
+		if (delayUntil <= delayedCallbacks[callbackHeap[child]].DelayUntil)
+			break;
+
+		callbackHeap[position]                               = callbackHeap[child];
+		delayedCallbacks[callbackHeap[position]].HeapIndex = position;
+		position                                             = child;
+	}
+
+	callbackHeap[position]            = index;
+	delayedCallbacks[index].HeapIndex = position;
+}
+
+void HighPrecisionCounter::HeapRemove(size_t position)
+{
+	callbackCount--;
+	if (position == callbackCount)
+		return;
+
+	// Move the last entry into the gap and restore the heap order in whichever direction it is broken
+	callbackHeap[position]                               = callbackHeap[callbackCount];
+	delayedCallbacks[callbackHeap[position]].HeapIndex = position;
+
+	if (position > 0 && delayedCallbacks[callbackHeap[position]].DelayUntil < delayedCallbacks[callbackHeap[(position - 1) / 2]].DelayUntil)
+		HeapSiftUp(position);
+	else
+		HeapSiftDown(position);
+}
+
+HighPrecisionCounter::CallbackHandle HighPrecisionCounter::AddCallbackAt(uint64_t time, const InplaceFunction<void()>& callback, uint64_t period)
+{
+	if (callback == nullptr)
+		return CallbackHandle();
 
 	for (size_t i = 0; i < delayedCallbacks.size(); i++)
 	{
 		// Search for an empty slot
 		DelayedCallback& delayedCallback = delayedCallbacks[i];
-		if (delayedCallback.Callback == nullptr || delayedCallback.DelayUntil == 0)
-		{
-			delayedCallback.DelayUntil = delayUntil;
-			delayedCallback.Callback   = callback;
+		if (delayedCallback.Callback != nullptr)
+			continue;
 
-			if (i >= highestCallbackIndex)
-				highestCallbackIndex = i + 1;
+		// The timer interrupt pops from the heap, so insert without being interrupted
+		uint32_t primask = EnterCriticalSection();
 
-			return true;
-		}
+		delayedCallback.DelayUntil = time;
+		delayedCallback.Period     = period;
+		delayedCallback.Callback   = callback;
+
+		callbackHeap[callbackCount] = i;
+		HeapSiftUp(callbackCount++);
+
+		if (isInitialized && delayedCallback.HeapIndex == 0)
+			ArmAlarm();
+
+		ExitCriticalSection(primask);
+
+		CallbackHandle handle;
+		handle.Index      = i;
+		handle.Generation = delayedCallback.Generation;
+		return handle;
 	}
 
 	// No empty slots
-	return false;
-}
\ No newline at end of file
+	return CallbackHandle();
+}
+
+bool HighPrecisionCounter::CancelCallback(CallbackHandle handle)
+{
+	if (handle.Index >= delayedCallbacks.size())
+		return false;
+
+	DelayedCallback& delayedCallback = delayedCallbacks[handle.Index];
+
+	uint32_t primask = EnterCriticalSection();
+
+	bool isQueued = delayedCallback.Callback != nullptr && delayedCallback.Generation == handle.Generation;
+	if (isQueued)
+	{
+		bool wasFirst = delayedCallback.HeapIndex == 0;
+
+		HeapRemove(delayedCallback.HeapIndex);
+		delayedCallback.Callback = nullptr;
+		delayedCallback.Generation++;
+
+		if (isInitialized && wasFirst)
+			ArmAlarm();
+	}
+
+	ExitCriticalSection(primask);
+
+	return isQueued;
+}
+
+bool HighPrecisionCounter::SynchronizeTo(uint64_t referenceTime)
+{
+	// The timer interrupt reads the discipline state to arm callbacks
+	uint32_t primask = EnterCriticalSection();
+
+	bool accepted = discipline.AddSample(GetRawCount(), referenceTime);
+	lastSyncTime  = referenceTime;
+
+	// Pending deadlines map to different raw counts now
+	if (isInitialized)
+		ArmAlarm();
+
+	ExitCriticalSection(primask);
+
+	return accepted;
+}
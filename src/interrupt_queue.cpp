@@ -1,51 +1,192 @@
 #include "interrupt_queue.hpp"
-
-#include "critical_section.h"
+#include "atomic_operations.hpp"
+#include "high_precision_counter.hpp"
+#include "profiler.hpp"
 
 #include <cstdio>
 
 using namespace PSR;
 
-std::array<std::function<void()>, InterruptQueue::MaxDepth> InterruptQueue::Queue;
-volatile size_t InterruptQueue::InterruptsPending = 0;
+// Zero initialized sequences mark every slot as free for the first lap
+std::array<InterruptQueue::Lane, InterruptQueue::PriorityCount> InterruptQueue::Lanes;
+const HighPrecisionCounter* InterruptQueue::TimeSource = nullptr;
+
+bool InterruptQueue::AddInterrupt(const InplaceFunction<void()>& callback, InterruptPriority priority)
+{
+	if ((size_t)priority >= PriorityCount)
+		return false;
+
+	Lane& lane        = Lanes[(size_t)priority];
+	uint32_t position = lane.Tail.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		Slot& slot       = lane.Slots[position % MaxDepth];
+		uint32_t lap     = position - position % MaxDepth;
+		uint32_t seq     = slot.Sequence.load(std::memory_order_acquire);
+		int32_t distance = (int32_t)(seq - lap);
+
+		if (distance == 0)
+		{
+			// Slot is free on this lap, try to claim it. On failure `position` is reloaded with the new tail
+			if (atomicCompareExchange(lane.Tail, position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (distance < 0)
+		{
+			// Slot still holds a callback from the previous lap, the lane is full
+			atomicFetchAdd(lane.Dropped, 1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			// Another interrupt claimed this slot first
+			position = lane.Tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	const HighPrecisionCounter* timeSource = TimeSource;
+
+	Slot& slot          = lane.Slots[position % MaxDepth];
+	slot.Callback       = callback;
+	slot.HasEnqueueTime = timeSource != nullptr;
+	slot.EnqueueTime    = timeSource != nullptr ? timeSource->GetCount() : 0;
+	slot.Sequence.store(position - position % MaxDepth + 1, std::memory_order_release);
+
+	atomicFetchAdd(lane.Enqueued, 1, std::memory_order_relaxed);
 
-bool InterruptQueue::AddInterrupt(const std::function<void()>& callback)
+	uint32_t depth     = position + 1 - lane.Head.load(std::memory_order_relaxed);
+	uint32_t watermark = lane.HighWatermark.load(std::memory_order_relaxed);
+	while (depth > watermark && !atomicCompareExchange(lane.HighWatermark, watermark, depth, std::memory_order_relaxed))
+	{}
+
+	return true;
+}
+
+bool InterruptQueue::RunNext(Lane& lane, uint32_t end)
 {
-	if (InterruptQueue::InterruptsPending >= InterruptQueue::MaxDepth)
+	uint32_t position = lane.Head.load(std::memory_order_relaxed);
+	if (position == end)
+		return false;
+
+	Slot& slot   = lane.Slots[position % MaxDepth];
+	uint32_t lap = position - position % MaxDepth;
+
+	// The slot is claimed but the interrupt that claimed it has not finished writing it
+	if (slot.Sequence.load(std::memory_order_acquire) != lap + 1)
 		return false;
 
-	// Disable interrupts while modifying the queue
-	uint32_t primask = EnterCriticalSection();
+	// Copy the callback out so the slot can be reused while the callback runs
+	InplaceFunction<void()> callback = slot.Callback;
+	uint64_t enqueueTime             = slot.EnqueueTime;
+	bool hasEnqueueTime              = slot.HasEnqueueTime;
+	slot.Sequence.store(lap + MaxDepth, std::memory_order_release);
+	lane.Head.store(position + 1, std::memory_order_relaxed);
+
+	const HighPrecisionCounter* timeSource = TimeSource;
+	if (timeSource != nullptr && hasEnqueueTime)
+	{
+		uint64_t elapsed = timeSource->GetCount() - enqueueTime;
+		uint32_t latency = elapsed > std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : (uint32_t)elapsed;
+
+		if (lane.Run == 0 || latency < lane.MinLatency)
+			lane.MinLatency = latency;
+		if (latency > lane.MaxLatency)
+			lane.MaxLatency = latency;
 
-	Queue[InterruptQueue::InterruptsPending] = callback;
-	InterruptQueue::InterruptsPending        = InterruptQueue::InterruptsPending + 1;
+		lane.TotalLatency += latency;
+		lane.Run++;
+	}
 
-	// Re-enable interrupts
-	ExitCriticalSection(primask);
+	if (callback)
+		callback();
 
 	return true;
 }
 
-void InterruptQueue::HandleQueue()
-{	
+void InterruptQueue::HandleQueue(uint32_t budgetMicroseconds)
+{
 	if ((SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0)
-		return;	// This should never be called from an interrupt, so if it is, return
+		return; // This should never be called from an interrupt, so if it is, return
 
-	if (InterruptsPending > 0)
+	PROFILE_ZONE("InterruptQueue::HandleQueue");
+
+	const HighPrecisionCounter* timeSource = TimeSource;
+	bool hasBudget                         = budgetMicroseconds != NoBudget && timeSource != nullptr;
+	uint64_t start                         = hasBudget ? timeSource->GetCount() : 0;
+
+	// Each lane runs at most one lap more than it held on entry, so a callback that re-queues itself cannot starve the main loop
+	std::array<uint32_t, PriorityCount> limits;
+	for (size_t i = 0; i < PriorityCount; i++)
+		limits[i] = Lanes[i].Tail.load(std::memory_order_relaxed) + MaxDepth;
+
+	// The lane being drained and the end of what it held when the drain reached it
+	size_t draining = PriorityCount;
+	uint32_t end    = 0;
+
+	for (;;)
 	{
-		for (size_t i = 0; i < InterruptsPending; i++)
+		// Restart from the highest lane after every callback so urgent work never waits behind a long lower priority drain
+		bool ranCallback = false;
+		for (size_t i = PriorityCount; i-- > 0;)
 		{
-			const std::function<void()>& interrupt = InterruptQueue::Queue[i];
-			if (interrupt)
+			Lane& lane = Lanes[i];
+			if (i != draining)
 			{
-				interrupt();
+				// Other lanes see what interrupts added since the last pass, a higher lane that has work preempts the drain
+				uint32_t tail = lane.Tail.load(std::memory_order_acquire);
+				if ((int32_t)(tail - limits[i]) > 0)
+					tail = limits[i];
+				if (tail == lane.Head.load(std::memory_order_relaxed))
+					continue;
+
+				draining = i;
+				end      = tail;
+			}
 
-				uint32_t primask         = EnterCriticalSection();
-				InterruptQueue::Queue[i] = nullptr;
-				ExitCriticalSection(primask);
+			if (RunNext(lane, end))
+			{
+				ranCallback = true;
+				break;
 			}
 		}
 
-		InterruptsPending = 0;
+		if (!ranCallback)
+			return;
+
+		if (hasBudget && timeSource->GetCount() - start >= budgetMicroseconds)
+			return;
+	}
+}
+
+InterruptQueue::Statistics InterruptQueue::GetStatistics(InterruptPriority priority)
+{
+	if ((size_t)priority >= PriorityCount)
+		return Statistics {};
+
+	const Lane& lane = Lanes[(size_t)priority];
+	return Statistics {
+		lane.Enqueued.load(std::memory_order_relaxed),
+		lane.Dropped.load(std::memory_order_relaxed),
+		lane.HighWatermark.load(std::memory_order_relaxed),
+		lane.Run,
+		lane.MinLatency,
+		lane.MaxLatency,
+		lane.TotalLatency,
+	};
+}
+
+void InterruptQueue::ResetStatistics()
+{
+	for (Lane& lane : Lanes)
+	{
+		lane.Enqueued.store(0, std::memory_order_relaxed);
+		lane.Dropped.store(0, std::memory_order_relaxed);
+		lane.HighWatermark.store(0, std::memory_order_relaxed);
+
+		lane.Run          = 0;
+		lane.MinLatency   = 0;
+		lane.MaxLatency   = 0;
+		lane.TotalLatency = 0;
 	}
 }
@@ -0,0 +1,92 @@
+/**
+ * @file profiler.cpp
+ * @author Purdue Solar Racing
+ * @brief Cycle counter profiling zones with per zone histograms
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "profiler.hpp"
+#include "critical_section.h"
+#include "syscall_retarget.hpp"
+
+#include STM32_INCLUDE(STM32_PROCESSOR, hal_rcc.h)
+
+using namespace PSR;
+
+// Built by the linker from the entries of every PROFILE_ZONE, weak so a program without zones links with an empty table
+extern "C" Profiler::Zone* const __start_profile_zones[] __attribute__((weak));
+extern "C" Profiler::Zone* const __stop_profile_zones[] __attribute__((weak));
+
+uint32_t Profiler::GetTickFrequency()
+{
+#ifdef STM32_HOST_SIMULATION
+	return 1000000000;
+#elif defined(CYCLE_COUNTER_AVAILABLE)
+	return HAL_RCC_GetHCLKFreq();
+#else
+	// One SysTick period per HAL tick, which is HAL_GetTickFreq() milliseconds long
+	return (SysTick->LOAD + 1) * (1000 / (uint32_t)HAL_GetTickFreq());
+#endif
+}
+
+void Profiler::Init()
+{
+#if !defined(STM32_HOST_SIMULATION) && defined(CYCLE_COUNTER_AVAILABLE)
+	CycleCounter::Init();
+#endif
+}
+
+size_t Profiler::GetZoneCount()
+{
+	return __start_profile_zones == nullptr ? 0 : __stop_profile_zones - __start_profile_zones;
+}
+
+const Profiler::Zone& Profiler::GetZone(size_t id)
+{
+	return *__start_profile_zones[id];
+}
+
+void Profiler::Reset()
+{
+	size_t count = GetZoneCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		Zone& zone = *__start_profile_zones[i];
+
+		uint32_t primask = EnterCriticalSection();
+		zone             = Zone(zone.Name);
+		ExitCriticalSection(primask);
+	}
+}
+
+void Profiler::Dump()
+{
+	print_debug("Profile zones, %lu ticks per second:\n", (unsigned long)GetTickFrequency());
+
+	size_t count = GetZoneCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		// Copy so a sample recorded while printing does not mix two states in one line
+		uint32_t primask = EnterCriticalSection();
+		Zone zone        = GetZone(i);
+		ExitCriticalSection(primask);
+
+		print_debug("%s: calls %lu, min %lu, mean %lu, max %lu\n",
+					zone.Name,
+					(unsigned long)zone.Calls,
+					(unsigned long)(zone.Calls == 0 ? 0 : zone.MinTicks),
+					(unsigned long)zone.GetMeanTicks(),
+					(unsigned long)zone.MaxTicks);
+
+		for (size_t bin = 0; bin < HistogramBins; bin++)
+		{
+			if (zone.Histogram[bin] == 0)
+				continue;
+
+			unsigned long low = bin == 0 ? 0 : 1ul << (bin - 1);
+			print_debug("\t%10lu+: %lu\n", low, (unsigned long)zone.Histogram[bin]);
+		}
+	}
+}
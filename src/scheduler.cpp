@@ -8,80 +8,253 @@
  *
  */
 #include "scheduler.hpp"
+#include "bit_operations.h"
+#include "critical_section.h"
 #include "errors.hpp"
+#include "profiler.hpp"
 
 using namespace PSR;
 
-bool Scheduler::Init()
+Status Scheduler::Init()
 {
 	if (isInitialized)
-		return true;
+		return Status::Ok();
 
 	if (tim == nullptr || frequency == 0 || frequency > HAL_RCC_GetSysClockFreq())
 	{
-		ErrorMessage::SetMessage("Scheduler: Invalid timer or frequency\n");
-		return false;
+		ErrorMessage::SetMessage(Errors::SchedulerInvalidConfiguration);
+		return Errors::SchedulerInvalidConfiguration;
 	}
 
-	tim->CR1 = 0;
+	Tim::CR1::Register::ResetRegister(tim);
 	if (!SetTimerFrequency(tim, frequency, timerPrecision))
 	{
-		ErrorMessage::SetMessage("Scheduler: Required timer precision is too high\n");
-		return false;
+		ErrorMessage::SetMessage(Errors::SchedulerPrecisionTooHigh);
+		return Errors::SchedulerPrecisionTooHigh;
 	}
-	tim->DIER |= TIM_DIER_UIE;
-	tim->CNT = -1;
-	tim->CR1 = TIM_CR1_CEN | TIM_CR1_ARPE;
-
 	tasks.fill(nullptr);
 	intervals.fill(0);
 	nextUpdates.fill(0);
 	enabledTasks.reset();
+	interruptTasks.reset();
+	budgets.fill(0);
+	worstExecutionTimes.fill(0);
+	overruns.fill(0);
+	wheel.fill(EndOfList);
+	wheelNext.fill(EndOfList);
+	wheelSlots.fill(0);
+
+#ifdef CYCLE_COUNTER_AVAILABLE
+	CycleCounter::Init();
+#else
+	uint32_t countFrequency = frequency * timerPrecision;
+	cyclesPerTimerCount     = (HAL_RCC_GetHCLKFreq() + countFrequency / 2) / countFrequency;
+#endif
+#ifdef SCHEDULER_STATISTICS
+	statistics.fill(EmptyStatistics);
+	released.reset();
+#endif
+
+	if (tickless)
+	{
+		// Upper bits of ARR read as zero on 16-bit timers
+		tim->ARR       = 0xFFFFFFFF;
+		uint64_t ticks = ((uint64_t)tim->ARR + 1) / timerPrecision;
+		maxPeriodTicks = ticks < timerRollOver ? ticks : timerRollOver - 1;
+		periodTicks    = maxPeriodTicks;
+		tim->ARR       = periodTicks * timerPrecision - 1;
+
+		// Load the prescaler without an update interrupt, ARR is written directly so that each period can be shortened
+		writeRegister(tim, Tim::CR1::URS::Set);
+		writeRegister(tim, Tim::EGR::UG::Set);
+		clearRegisterFlags(tim, Tim::SR::UIF::Set);
+		modifyRegister(tim, Tim::DIER::UIE::Set);
+		writeRegister(tim, Tim::CR1::CEN::Set | Tim::CR1::URS::Set);
+	}
+	else
+	{
+		modifyRegister(tim, Tim::DIER::UIE::Set);
+		tim->CNT = -1;
+		writeRegister(tim, Tim::CR1::CEN::Set | Tim::CR1::ARPE::Set);
+	}
 
 	isInitialized = true;
 
-	return true;
+	return Status::Ok();
 }
 
 void Scheduler::Update()
 {
-	if (!isInitialized || paused)
+	if (!isInitialized)
+		return;
+
+#ifndef CYCLE_COUNTER_AVAILABLE
+	// The timer keeps counting while paused, so the timestamps follow it before anything else
+	timerCountBase += (tickless ? periodTicks : 1) * timerPrecision;
+#endif
+
+	if (paused)
 		return;
 
-	if (++counter >= timerRollOver)
-		counter = 0;
+	PROFILE_ZONE("Scheduler::Update");
+
+#ifdef SCHEDULER_STATISTICS
+	tickStartTime = GetTimestamp();
+#endif
 
-	// Uses highest task index to avoid iterating through all tasks
-	for (size_t i = 0; i < highestTaskIndex; i++)
+	if (!tickless)
 	{
-		std::function<void()>& task = tasks[i];
-		if (task == nullptr || !enabledTasks[i])
-			continue;
+		if (++counter >= timerRollOver)
+			counter = 0;
+
+		ProcessTick();
+		return;
+	}
+
+	// The period ended at the earliest deadline, so only its last lap of the wheel can hold due tasks
+	uint32_t elapsed = periodTicks;
+	if (elapsed > WheelSize)
+	{
+		counter = GetNextUpdate(counter, timerRollOver, elapsed - WheelSize);
+		elapsed = WheelSize;
+	}
+
+	for (uint32_t i = 0; i < elapsed; i++)
+	{
+		counter = GetNextUpdate(counter, timerRollOver, 1);
+		ProcessTick();
+	}
+
+	ArmNextUpdate();
+}
+
+void Scheduler::ProcessTick()
+{
+	// Only visit the tasks linked into the wheel slot for this tick
+	uint8_t* link = &wheel[counter & WheelMask];
+	while (*link != EndOfList)
+	{
+		size_t i = *link;
 
 		int32_t diff = counter - nextUpdates[i];
 
-		if (diff >= 0 && diff < (int32_t)(timerPrecision / 2))
+		// Disabled, or due on a later lap of the wheel
+		if (!enabledTasks[i] || diff < 0)
+		{
+			link = &wheelNext[i];
+			continue;
+		}
+
+		// Missed the window, wait for the counter to come back around
+		bool missed = diff >= (int32_t)(timerPrecision / 2);
+		// Already in its own slot, relinking it into the slot being walked would visit it again forever
+		if (missed && wheelSlots[i] == (nextUpdates[i] & WheelMask))
 		{
-			// If the interrupt queue is full, try again next time
-			if (!InterruptQueue::AddInterrupt(task))
+			link = &wheelNext[i];
+			continue;
+		}
+
+		*link = wheelNext[i];
+
+		// Retried after a full queue or enabled late, move it back to its own slot
+		if (missed)
+		{
+			LinkTask(i, nextUpdates[i]);
+			continue;
+		}
+
+		if (interruptTasks[i])
+		{
+			RunInterruptTask(i);
+		}
+		else
+		{
+#ifdef SCHEDULER_STATISTICS
+			bool queued = InterruptQueue::AddInterrupt([this, i]() { RunTask(i); });
+#else
+			bool queued = InterruptQueue::AddInterrupt(tasks[i]);
+#endif
+
+			// If the interrupt queue is full, try again next tick
+			if (!queued)
+			{
+				LinkTask(i, GetNextUpdate(counter, timerRollOver, 1));
 				continue;
-			
-			if (intervals[i] == 0)
+			}
+
+#ifdef SCHEDULER_STATISTICS
+			// Still waiting on the previous release, keep its release time so the jitter covers the whole delay
+			if (released[i])
 			{
-				task            = nullptr;
-				intervals[i]    = 0;
-				nextUpdates[i]  = 0;
-				enabledTasks[i] = false;
+				statistics[i].MissedDeadlines++;
 			}
 			else
 			{
-				nextUpdates[i] = GetNextUpdate(counter, timerRollOver, intervals[i]);
+				statistics[i].ReleaseTime = GetTimestamp();
+				released[i]               = true;
 			}
+#endif
+		}
+
+		if (intervals[i] == 0)
+		{
+#ifdef SCHEDULER_STATISTICS
+			// A queued call still needs the slot, RunTask frees it once it has run
+			if (interruptTasks[i])
+				tasks[i] = nullptr;
+#else
+			tasks[i] = nullptr;
+#endif
+			intervals[i]    = 0;
+			nextUpdates[i]  = 0;
+			enabledTasks[i] = false;
+			wheelNext[i]    = EndOfList;
+		}
+		else
+		{
+			nextUpdates[i] = GetNextUpdate(counter, timerRollOver, intervals[i]);
+			LinkTask(i, nextUpdates[i]);
 		}
 	}
 }
 
-size_t Scheduler::AddTask(const std::function<void()>& task, uint32_t interval, uint32_t startOffset, bool enabled)
+void Scheduler::RunInterruptTask(size_t index)
+{
+	uint32_t start = GetTimestamp();
+	tasks[index]();
+	uint32_t end = GetTimestamp();
+
+	uint32_t executionTime = end - start;
+	if (executionTime > worstExecutionTimes[index])
+		worstExecutionTimes[index] = executionTime;
+	if (executionTime > budgets[index])
+		overruns[index]++;
+
+#ifdef SCHEDULER_STATISTICS
+	statistics[index].ReleaseTime = tickStartTime;
+	RecordRun(index, start, end, true);
+#endif
+}
+
+uint32_t Scheduler::GetTimestamp() const
+{
+#ifdef CYCLE_COUNTER_AVAILABLE
+	return CycleCounter::GetCount();
+#else
+	uint32_t primask = EnterCriticalSection();
+
+	uint32_t counts = timerCountBase + tim->CNT;
+	// The period ended but Update has not run yet, the count restarted from zero
+	if (Tim::SR::UIF::Read(tim) != 0)
+		counts = timerCountBase + (tickless ? periodTicks : 1) * timerPrecision + tim->CNT;
+
+	ExitCriticalSection(primask);
+
+	return counts * cyclesPerTimerCount;
+#endif
+}
+
+size_t Scheduler::InsertTask(const InplaceFunction<void()>& task, uint32_t interval, uint32_t startOffset, bool enabled, bool inInterrupt, uint32_t budget)
 {
 	if (startOffset >= timerRollOver || interval >= timerRollOver)
 		return InvalidTaskId;
@@ -90,13 +263,25 @@ size_t Scheduler::AddTask(const std::function<void()>& task, uint32_t interval,
 	{
 		if (tasks[i] == nullptr)
 		{
-			tasks[i]        = task;
-			intervals[i]    = interval;
-			nextUpdates[i]  = GetFirstUpdate(counter, interval, startOffset);
-			enabledTasks[i] = enabled;
+			// The timer interrupt walks the wheel, so link the task without being interrupted
+			uint32_t primask = EnterCriticalSection();
 
-			if (i >= highestTaskIndex)
-				highestTaskIndex = i + 1; // Update highest task index to the empty slot above
+			tasks[i]               = task;
+			intervals[i]           = interval;
+			nextUpdates[i]         = GetFirstUpdate(GetCounter(), interval, startOffset);
+			enabledTasks[i]        = enabled;
+			interruptTasks[i]      = inInterrupt;
+			budgets[i]             = budget;
+			worstExecutionTimes[i] = 0;
+			overruns[i]            = 0;
+			LinkTask(i, nextUpdates[i]);
+#ifdef SCHEDULER_STATISTICS
+			statistics[i] = EmptyStatistics;
+			released[i]   = false;
+#endif
+			Reschedule();
+
+			ExitCriticalSection(primask);
 
 			return i;
 		}
@@ -105,27 +290,194 @@ size_t Scheduler::AddTask(const std::function<void()>& task, uint32_t interval,
 	return InvalidTaskId;
 }
 
+void Scheduler::EnableTask(size_t index)
+{
+	if (index >= MaxTasks)
+		return;
+
+	uint32_t primask = EnterCriticalSection();
+
+	enabledTasks[index] = true;
+
+	// Its tick passed while it was disabled, the wheel would not visit it again for a whole lap,
+	// so retry it on the next tick like a task that could not be queued
+	uint32_t now = GetCounter();
+	int32_t late = now - nextUpdates[index];
+	if (tasks[index] != nullptr && late >= 0 && late < (int32_t)(timerPrecision / 2))
+	{
+		UnlinkTask(index);
+		LinkTask(index, GetNextUpdate(now, timerRollOver, 1));
+	}
+	Reschedule();
+
+	ExitCriticalSection(primask);
+}
+
 bool Scheduler::RemoveTask(size_t index)
 {
 	if (index >= MaxTasks)
 		return false;
 
-	tasks[index]        = nullptr;
-	intervals[index]    = 0;
-	nextUpdates[index]  = 0;
-	enabledTasks[index] = false;
+	uint32_t primask = EnterCriticalSection();
+
+	if (tasks[index] != nullptr)
+		UnlinkTask(index);
+
+	tasks[index]          = nullptr;
+	intervals[index]      = 0;
+	nextUpdates[index]    = 0;
+	enabledTasks[index]   = false;
+	interruptTasks[index] = false;
+
+	ExitCriticalSection(primask);
+
+	return true;
+}
+
+uint32_t Scheduler::GetCounter() const
+{
+	if (!tickless || !isInitialized)
+		return counter;
+
+	uint32_t primask = EnterCriticalSection();
+
+	uint32_t elapsed = tim->CNT / timerPrecision;
+	// The period ended but Update has not run yet, the count restarted from zero
+	if (Tim::SR::UIF::Read(tim) != 0)
+		elapsed = periodTicks + tim->CNT / timerPrecision;
+
+	uint32_t now = GetNextUpdate(counter, timerRollOver, elapsed);
+
+	ExitCriticalSection(primask);
+
+	return now;
+}
+
+uint32_t Scheduler::GetTicksToNextUpdate() const
+{
+	uint32_t next = maxPeriodTicks;
+
+	// Only visit the enabled tasks instead of testing every slot
+	static_assert(MaxTasks <= 64, "The enabled tasks must fit in one word");
+	uint64_t enabled = enabledTasks.to_ullong();
+	forEachSetBit(&enabled, MaxTasks, [this, &next](size_t i) {
+		uint32_t ticks;
+		int32_t late = counter - nextUpdates[i];
+		if (late >= 0 && late < (int32_t)(timerPrecision / 2))
+			ticks = 1; // Could not be queued, it is retried on the next tick
+		else if (nextUpdates[i] > counter)
+			ticks = nextUpdates[i] - counter;
+		else
+			ticks = nextUpdates[i] + timerRollOver - counter;
+
+		if (ticks < next)
+			next = ticks;
+	});
+
+	return next;
+}
+
+void Scheduler::ArmNextUpdate()
+{
+	periodTicks = GetTicksToNextUpdate();
+	tim->ARR    = periodTicks * timerPrecision - 1;
+
+	// The counter passed the new end before it was written, end the period on the next count instead of after a full wrap
+	if (tim->CNT > tim->ARR)
+		tim->CNT = tim->ARR;
+}
+
+void Scheduler::Reschedule()
+{
+	if (!tickless || !isInitialized)
+		return;
+
+	uint32_t primask = EnterCriticalSection();
 
-	if (index == highestTaskIndex - 1)
+	// A pending update re-arms the timer after walking the wheel, which sees the change
+	if (Tim::SR::UIF::Read(tim) == 0)
 	{
-		for (size_t i = highestTaskIndex - 1; i > 0; i--)
+		uint32_t ticks = GetTicksToNextUpdate();
+		if (ticks < periodTicks)
 		{
-			if (tasks[i] != nullptr)
-			{
-				highestTaskIndex = i + 1;
-				break;
-			}
+			// A deadline inside the part of the period that already elapsed is handled at the next tick
+			uint32_t elapsed = tim->CNT / timerPrecision;
+			if (ticks <= elapsed)
+				ticks = elapsed + 1;
+
+			periodTicks = ticks;
+			tim->ARR    = periodTicks * timerPrecision - 1;
+
+			if (tim->CNT > tim->ARR)
+				tim->CNT = tim->ARR;
 		}
 	}
 
-	return true;
+	ExitCriticalSection(primask);
+}
+
+#ifdef SCHEDULER_STATISTICS
+void Scheduler::RunTask(size_t index)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	InplaceFunction<void()> task = tasks[index];
+	// A one-shot task is disabled when it is released, its slot is only freed once it has run
+	if (intervals[index] == 0 && !enabledTasks[index])
+		tasks[index] = nullptr;
+
+	bool wasReleased = released[index];
+	released[index]  = false;
+
+	ExitCriticalSection(primask);
+
+	// Removed while it was waiting in the interrupt queue
+	if (task == nullptr)
+		return;
+
+	uint32_t start = GetTimestamp();
+	task();
+	uint32_t end = GetTimestamp();
+
+	primask = EnterCriticalSection();
+	// A second queued call for the same release has nothing to measure its jitter against
+	RecordRun(index, start, end, wasReleased);
+	ExitCriticalSection(primask);
+}
+
+void Scheduler::RecordRun(size_t index, uint32_t start, uint32_t end, bool measureJitter)
+{
+	TaskStatistics& stats = statistics[index];
+	stats.StartTime       = start;
+	stats.ExecutionTime   = end - start;
+	stats.TotalExecutionTime += stats.ExecutionTime;
+	if (stats.ExecutionTime > stats.MaxExecutionTime)
+		stats.MaxExecutionTime = stats.ExecutionTime;
+
+	if (measureJitter)
+	{
+		uint32_t jitter = start - stats.ReleaseTime;
+		stats.TotalJitter += jitter;
+		if (jitter < stats.MinJitter)
+			stats.MinJitter = jitter;
+		if (jitter > stats.MaxJitter)
+			stats.MaxJitter = jitter;
+	}
+
+	stats.Runs++;
+}
+
+void Scheduler::GetStatistics(Statistics& statistics) const
+{
+	uint32_t primask = EnterCriticalSection();
+	statistics       = this->statistics;
+	ExitCriticalSection(primask);
+}
+
+void Scheduler::ResetStatistics()
+{
+	uint32_t primask = EnterCriticalSection();
+	statistics.fill(EmptyStatistics);
+	ExitCriticalSection(primask);
 }
+#endif
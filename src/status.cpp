@@ -0,0 +1,99 @@
+#include "status.hpp"
+#include "critical_section.h"
+#include "errors.hpp"
+
+#include <cstdio>
+
+using namespace PSR;
+
+using Entry = ErrorRegistry::Entry;
+
+static constexpr const char* GeneralDescriptions[] = {
+	"Result has no value",
+};
+
+static constexpr const char* SchedulerDescriptions[] = {
+	"Invalid timer or frequency",
+	"Required timer precision is too high",
+};
+
+static constexpr const char* UartDescriptions[] = {
+	"Busy",
+	"Timed out",
+	"Receive DMA is not in circular mode",
+};
+
+static constexpr Entry LibraryEntries[] = {
+	{ Subsystem::General, "Error", GeneralDescriptions, sizeof(GeneralDescriptions) / sizeof(GeneralDescriptions[0]) },
+	{ Subsystem::Scheduler, "Scheduler", SchedulerDescriptions, sizeof(SchedulerDescriptions) / sizeof(SchedulerDescriptions[0]) },
+	{ Subsystem::InterruptQueue, "InterruptQueue", nullptr, 0 },
+	{ Subsystem::Counter, "Counter", nullptr, 0 },
+	{ Subsystem::Uart, "UART", UartDescriptions, sizeof(UartDescriptions) / sizeof(UartDescriptions[0]) },
+	{ Subsystem::Can, "CAN", nullptr, 0 },
+};
+
+Entry ErrorRegistry::entries[MaxSubsystems];
+size_t ErrorRegistry::count = 0;
+
+const Entry* ErrorRegistry::Find(Subsystem id)
+{
+	for (const Entry& entry : LibraryEntries)
+	{
+		if (entry.Id == id)
+			return &entry;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (entries[i].Id == id)
+			return &entries[i];
+	}
+
+	return nullptr;
+}
+
+bool ErrorRegistry::Register(Subsystem id, const char* name, const char* const* descriptions, size_t descriptionCount)
+{
+	if (id < Subsystem::Application)
+		return false;
+
+	uint32_t primask = EnterCriticalSection();
+
+	bool registered = count < MaxSubsystems && Find(id) == nullptr;
+	if (registered)
+		entries[count++] = Entry { id, name, descriptions, descriptionCount };
+
+	ExitCriticalSection(primask);
+
+	return registered;
+}
+
+size_t ErrorRegistry::Describe(ErrorCode code, char* buffer, size_t size)
+{
+	if (buffer == nullptr || size == 0)
+		return 0;
+
+	const Entry* entry = Find(code.GetSubsystem());
+	int length;
+	if (entry == nullptr)
+		length = snprintf(buffer, size, "Subsystem %u: Error %u", (unsigned)code.GetSubsystem(), (unsigned)code.GetCode());
+	else if (code.GetCode() == 0 || code.GetCode() > entry->Count)
+		length = snprintf(buffer, size, "%s: Error %u", entry->Name, (unsigned)code.GetCode());
+	else
+		length = snprintf(buffer, size, "%s: %s", entry->Name, entry->Descriptions[code.GetCode() - 1]);
+
+	if (length < 0)
+		return 0;
+
+	return (size_t)length < size ? (size_t)length : size - 1;
+}
+
+size_t Status::WriteMessage(char* buffer, size_t size) const
+{
+	return ErrorMessage::WriteMessage(*this, buffer, size);
+}
+
+void Status::Report() const
+{
+	ErrorMessage::SetMessage(*this);
+}
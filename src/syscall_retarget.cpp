@@ -2,10 +2,12 @@
 #include STM32_INCLUDE(STM32_PROCESSOR, hal.h)
 #include STM32_INCLUDE(STM32_PROCESSOR, hal_def.h)
 #include STM32_INCLUDE(STM32_PROCESSOR, hal_uart.h)
+#include "critical_section.h"
 #include "syscall_retarget.hpp"
 #include <errno.h>
 #include <functional>
 #include <stdio.h>
+#include <string.h>
 #include <sys/unistd.h>
 
 UART_HandleTypeDef* stdoutUart = nullptr;
@@ -13,6 +15,156 @@ uint32_t stdoutTimeout = 0;
 std::function<void()> writeOnTxStart;
 std::function<void()> writeOnTxEnd;
 
+namespace
+{
+
+constexpr uint32_t TxBufferSize = SYSCALL_TX_BUFFER_SIZE;
+static_assert((TxBufferSize & (TxBufferSize - 1)) == 0, "SYSCALL_TX_BUFFER_SIZE must be a power of two");
+
+uint8_t txBuffer[TxBufferSize];
+// Free running indices, the queued bytes are [txTail, txHead) and the first txBurst of them are being sent
+volatile uint32_t txHead  = 0;
+volatile uint32_t txTail  = 0;
+volatile uint32_t txBurst = 0;
+
+bool txBuffered               = false;
+TxDrainMode txMode            = TxDrainMode::DMA;
+TxFullPolicy txPolicy         = TxFullPolicy::Drop;
+UARTTxStatistics txStatistics = {};
+
+constexpr uint32_t RxBufferSize = SYSCALL_RX_BUFFER_SIZE;
+static_assert((RxBufferSize & (RxBufferSize - 1)) == 0, "SYSCALL_RX_BUFFER_SIZE must be a power of two");
+static_assert(RxBufferSize <= UINT16_MAX, "SYSCALL_RX_BUFFER_SIZE must fit in one DMA transfer");
+
+uint8_t rxBuffer[RxBufferSize];
+// Free running indices, the received bytes are [rxTail, rxHead)
+volatile uint32_t rxHead = 0;
+volatile uint32_t rxTail = 0;
+
+UART_HandleTypeDef* stdinUart = nullptr;
+UARTRxStatistics rxStatistics = {};
+
+bool InInterrupt()
+{
+	return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
+}
+
+/// @brief Spin once while waiting for the running transfers, the host simulation advances its virtual clock on a `__NOP`
+void WaitForLine()
+{
+	__NOP();
+}
+
+/// @brief Send the queued bytes if no transfer is running, must be called with interrupts disabled
+void StartBurst()
+{
+	if (txBurst != 0 || txHead == txTail)
+		return;
+
+	// A transfer stops at the end of the ring, the wrapped part is sent by the next one
+	uint32_t start  = txTail % TxBufferSize;
+	uint32_t length = txHead - txTail;
+	if (length > TxBufferSize - start)
+		length = TxBufferSize - start;
+	if (length > UINT16_MAX)
+		length = UINT16_MAX;
+
+	txBurst = length;
+	if (writeOnTxStart)
+		writeOnTxStart();
+
+	HAL_StatusTypeDef status = txMode == TxDrainMode::DMA ? HAL_UART_Transmit_DMA(stdoutUart, &txBuffer[start], (uint16_t)length)
+	                                                      : HAL_UART_Transmit_IT(stdoutUart, &txBuffer[start], (uint16_t)length);
+	if (status != HAL_OK)
+	{
+		// The bytes stay queued and are retried by the next write
+		txBurst = 0;
+		if (writeOnTxEnd)
+			writeOnTxEnd();
+		return;
+	}
+
+	txStatistics.Bursts++;
+}
+
+/// @brief Copy bytes that fit into the ring, must be called with interrupts disabled
+void Enqueue(const uint8_t* data, uint32_t size)
+{
+	uint32_t start = txHead % TxBufferSize;
+	uint32_t first = size < TxBufferSize - start ? size : TxBufferSize - start;
+	memcpy(&txBuffer[start], data, first);
+	memcpy(txBuffer, data + first, size - first);
+
+	txHead = txHead + size;
+	txStatistics.Written += size;
+
+	uint32_t used = txHead - txTail;
+	if (used > txStatistics.HighWatermark)
+		txStatistics.HighWatermark = used;
+}
+
+void WriteBuffered(const uint8_t* data, uint32_t size)
+{
+	// Waiting for room only works if the transfer complete interrupt can run
+	bool canBlock  = txPolicy == TxFullPolicy::Block && !InInterrupt() && __get_PRIMASK() == 0;
+	uint32_t start  = HAL_GetTick();
+
+	while (size > 0)
+	{
+		bool wait = canBlock && HAL_GetTick() - start < stdoutTimeout;
+
+		uint32_t primask = EnterCriticalSection();
+
+		uint32_t space = TxBufferSize - (txHead - txTail);
+		if (space < size && txPolicy == TxFullPolicy::Overwrite)
+		{
+			// Discard only as many of the oldest queued bytes that are not being sent as are needed, then the oldest new bytes
+			// if the rest still does not fit. The kept bytes move down over the discarded ones, the burst is in use by the UART
+			uint32_t queued  = txHead - txTail - txBurst;
+			uint32_t discard = size - space < queued ? size - space : queued;
+			for (uint32_t i = txTail + txBurst; i + discard != txHead; i++)
+				txBuffer[i % TxBufferSize] = txBuffer[(i + discard) % TxBufferSize];
+
+			txHead = txHead - discard;
+			space += discard;
+			txStatistics.Dropped += discard;
+
+			if (size > space)
+			{
+				txStatistics.Dropped += size - space;
+				data += size - space;
+				size = space;
+			}
+		}
+
+		uint32_t count = size < space ? size : space;
+		Enqueue(data, count);
+		data += count;
+		size -= count;
+
+		if (size > 0 && !wait)
+		{
+			txStatistics.Dropped += size;
+			size = 0;
+		}
+
+		StartBurst();
+		ExitCriticalSection(primask);
+
+		if (size > 0)
+			WaitForLine();
+	}
+}
+
+bool StartReceive()
+{
+	rxHead = 0;
+	rxTail = 0;
+	return HAL_UARTEx_ReceiveToIdle_DMA(stdinUart, rxBuffer, RxBufferSize) == HAL_OK;
+}
+
+} // namespace
+
 void SyscallUARTRetarget(UART_HandleTypeDef* huart, uint32_t timeout, std::function<void()> onTxStart, std::function<void()> onTxEnd)
 {
 	stdoutUart    = huart;
@@ -20,6 +172,165 @@ void SyscallUARTRetarget(UART_HandleTypeDef* huart, uint32_t timeout, std::funct
 
 	writeOnTxStart = onTxStart;
 	writeOnTxEnd   = onTxEnd;
+	txBuffered     = false;
+}
+
+void SyscallUARTRetargetBuffered(UART_HandleTypeDef* huart, uint32_t timeout, TxDrainMode mode, TxFullPolicy policy, std::function<void()> onTxStart, std::function<void()> onTxEnd)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	stdoutUart    = huart;
+	stdoutTimeout = timeout;
+
+	writeOnTxStart = onTxStart;
+	writeOnTxEnd   = onTxEnd;
+
+	txMode       = mode;
+	txPolicy     = policy;
+	txHead       = 0;
+	txTail       = 0;
+	txBurst      = 0;
+	txStatistics = {};
+	txBuffered   = true;
+
+	ExitCriticalSection(primask);
+}
+
+void SyscallUARTTxComplete(UART_HandleTypeDef* huart)
+{
+	if (!txBuffered || huart != stdoutUart)
+		return;
+
+	uint32_t primask = EnterCriticalSection();
+
+	txTail  = txTail + txBurst;
+	txBurst = 0;
+	if (writeOnTxEnd)
+		writeOnTxEnd();
+
+	StartBurst();
+
+	ExitCriticalSection(primask);
+}
+
+UARTTxStatistics GetUARTTxStatistics()
+{
+	uint32_t primask            = EnterCriticalSection();
+	UARTTxStatistics statistics = txStatistics;
+	ExitCriticalSection(primask);
+
+	return statistics;
+}
+
+bool SyscallUARTFlush(uint32_t timeout)
+{
+	uint32_t start = HAL_GetTick();
+	while (txBuffered && txHead != txTail)
+	{
+		if (HAL_GetTick() - start >= timeout)
+			return false;
+
+		WaitForLine();
+	}
+
+	return true;
+}
+
+PSR::Status SyscallUARTStartReceive(UART_HandleTypeDef* huart)
+{
+	// A normal mode transfer stops at the first event and would lose everything until it is restarted
+	if (huart->hdmarx == nullptr || huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+		return PSR::Errors::UartNotCircular;
+
+	HAL_UART_AbortReceive(huart);
+
+	uint32_t primask = EnterCriticalSection();
+	stdinUart        = huart;
+	rxStatistics     = {};
+	bool started     = StartReceive();
+	ExitCriticalSection(primask);
+
+	if (!started)
+	{
+		stdinUart = nullptr;
+		return PSR::Errors::UartBusy;
+	}
+
+	return PSR::Status::Ok();
+}
+
+void SyscallUARTRxEvent(UART_HandleTypeDef* huart, uint16_t size)
+{
+	if (huart != stdinUart)
+		return;
+
+	uint32_t primask = EnterCriticalSection();
+
+	// The event reports the DMA position, which is the buffer size at the end of the buffer
+	uint32_t count = (size - rxHead) & (RxBufferSize - 1);
+	rxHead         = rxHead + count;
+	rxStatistics.Received += count;
+	rxStatistics.Events++;
+
+	uint32_t used = rxHead - rxTail;
+	if (used > RxBufferSize)
+	{
+		rxStatistics.Overrun += used - RxBufferSize;
+		rxTail = rxHead - RxBufferSize;
+	}
+
+	ExitCriticalSection(primask);
+}
+
+void SyscallUARTRxError(UART_HandleTypeDef* huart)
+{
+	if (huart != stdinUart)
+		return;
+
+	uint32_t primask = EnterCriticalSection();
+
+	rxStatistics.Overrun += rxHead - rxTail;
+	rxStatistics.Restarts++;
+
+	HAL_UART_AbortReceive(huart);
+	StartReceive();
+
+	ExitCriticalSection(primask);
+}
+
+size_t SyscallUARTAvailable()
+{
+	return rxHead - rxTail;
+}
+
+size_t SyscallUARTPeek(const uint8_t** data)
+{
+	uint32_t primask = EnterCriticalSection();
+	uint32_t start   = rxTail & (RxBufferSize - 1);
+	uint32_t count   = rxHead - rxTail;
+	ExitCriticalSection(primask);
+
+	*data = &rxBuffer[start];
+	return count < RxBufferSize - start ? count : RxBufferSize - start;
+}
+
+void SyscallUARTConsume(size_t count)
+{
+	uint32_t primask = EnterCriticalSection();
+
+	uint32_t available = rxHead - rxTail;
+	rxTail             = rxTail + (count < available ? count : available);
+
+	ExitCriticalSection(primask);
+}
+
+UARTRxStatistics GetUARTRxStatistics()
+{
+	uint32_t primask            = EnterCriticalSection();
+	UARTRxStatistics statistics = rxStatistics;
+	ExitCriticalSection(primask);
+
+	return statistics;
 }
 
 extern "C"
@@ -31,6 +342,19 @@ extern "C"
 
 	int _write(int file, char* ptr, int len)
 	{
+		if (txBuffered)
+		{
+			if (!(file == STDOUT_FILENO || file == STDERR_FILENO))
+			{
+				errno = EBADF;
+				return -1;
+			}
+
+			// Dropped bytes are reported as written, the C library would otherwise retry them forever
+			WriteBuffered((const uint8_t*)ptr, len);
+			return len;
+		}
+
 		if (writeOnTxStart)
 			writeOnTxStart();
 
@@ -55,6 +379,37 @@ extern "C"
 			return -1;
 		}
 
+		if (stdinUart != nullptr)
+		{
+			uint32_t start = HAL_GetTick();
+			while (SyscallUARTAvailable() == 0)
+			{
+				if (HAL_GetTick() - start >= stdoutTimeout || InInterrupt())
+				{
+					errno = EAGAIN;
+					return -1;
+				}
+
+				WaitForLine();
+			}
+
+			int count = 0;
+			while (count < len)
+			{
+				const uint8_t* data;
+				size_t size = SyscallUARTPeek(&data);
+				if (size == 0)
+					break;
+
+				size = size < (size_t)(len - count) ? size : (size_t)(len - count);
+				memcpy(ptr + count, data, size);
+				SyscallUARTConsume(size);
+				count += size;
+			}
+
+			return count;
+		}
+
 		HAL_StatusTypeDef status = HAL_UART_Receive(stdoutUart, (uint8_t*)ptr, len, stdoutTimeout);
 		return status == HAL_OK ? len : 0;
 	}
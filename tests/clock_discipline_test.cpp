@@ -0,0 +1,107 @@
+/**
+ * @file clock_discipline_test.cpp
+ * @author Purdue Solar Racing
+ * @brief Host simulation of ClockDiscipline locking a drifting counter to a reference
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "clock_discipline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+using namespace PSR;
+
+namespace
+{
+
+struct Drift
+{
+	double Ppm;      ///< @brief How fast the local crystal runs, in parts per million
+	double Interval; ///< @brief Microseconds of reference time between sync pulses
+	double Noise;    ///< @brief The standard deviation of the sample timestamps in microseconds
+	double MaxError; ///< @brief The largest allowed error once settled, in microseconds
+};
+
+class ClockDisciplineDriftTest : public ::testing::TestWithParam<Drift>
+{};
+
+/// @brief The raw counter value when the reference reads `reference`, for a crystal `ppm` off that started 12345 us early
+uint64_t RawAt(double reference, double ppm)
+{
+	return (uint64_t)(reference * (1 + ppm * 1e-6) + 12345);
+}
+
+TEST_P(ClockDisciplineDriftTest, AlignsToTheReference)
+{
+	const Drift drift = GetParam();
+
+	ClockDiscipline discipline;
+	std::mt19937 random(1);
+	std::normal_distribution<double> noise(0, drift.Noise);
+
+	double maxError = 0;
+	for (int pulse = 1; pulse <= 200; pulse++)
+	{
+		double reference = pulse * drift.Interval;
+		discipline.AddSample((uint64_t)((double)RawAt(reference, drift.Ppm) + noise(random)), (uint64_t)reference);
+
+		// Check the disciplined time through the whole interval up to the next pulse, once the loop has settled
+		if (pulse <= 20)
+			continue;
+
+		for (int step = 1; step <= 10; step++)
+		{
+			double time  = reference + step * drift.Interval / 10;
+			double error = std::fabs((double)discipline.ToDisciplined(RawAt(time, drift.Ppm)) - time);
+			maxError     = std::max(maxError, error);
+		}
+	}
+
+	EXPECT_LT(maxError, drift.MaxError);
+
+	ClockDiscipline::Statistics statistics = discipline.GetStatistics();
+	// The learned frequency still wanders by a few ppm with the sample noise
+	EXPECT_NEAR(statistics.SkewPpb, -drift.Ppm * 1000, 5000);
+	EXPECT_EQ(statistics.Steps, 1u);
+}
+
+// The rate correction is limited to 500 ppm, which has to cover the proportional term on top of the drift
+INSTANTIATE_TEST_SUITE_P(PpmOffsets, ClockDisciplineDriftTest,
+                         ::testing::Values(Drift { 50, 1e6, 2, 10 }, Drift { -200, 1e6, 2, 10 }, Drift { 400, 1e6, 2, 10 },
+                                           Drift { 100, 1e5, 1, 10 }),
+                         [](const ::testing::TestParamInfo<Drift>& info) { return "Drift" + std::to_string(info.index); });
+
+TEST(ClockDisciplineTest, SlewEndsAfterOneInterval)
+{
+	ClockDiscipline discipline;
+	discipline.AddSample(0, 0);
+	// 200 us fast after one second, the loop learns a quarter of that as frequency and slews out half over the next second
+	ASSERT_TRUE(discipline.AddSample(1000000, 1000000 - 200));
+	EXPECT_EQ(discipline.ToDisciplined(1000000), 1000000u);
+	EXPECT_NEAR((double)discipline.ToDisciplined(2000000), 2000000 - 150, 1);
+
+	// Without another sample only the learned 50 ppm carries on, the slew does not keep going
+	EXPECT_NEAR((double)discipline.ToDisciplined(11000000), 11000000 - 150 - 450, 1);
+}
+
+TEST(ClockDisciplineTest, ToRawInvertsAcrossTheSlewEnd)
+{
+	ClockDiscipline discipline;
+	discipline.AddSample(0, 0);
+	ASSERT_TRUE(discipline.AddSample(1000000, 1000000 - 200));
+
+	for (uint64_t time = 1000000; time < 3000000; time += 9973)
+	{
+		uint64_t raw = discipline.ToRaw(time);
+		EXPECT_GE(discipline.ToDisciplined(raw), time);
+		EXPECT_LT(discipline.ToDisciplined(raw - 1), time);
+	}
+}
+
+} // namespace
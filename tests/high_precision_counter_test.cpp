@@ -0,0 +1,243 @@
+/**
+ * @file high_precision_counter_test.cpp
+ * @author Purdue Solar Racing
+ * @brief Host tests of HighPrecisionCounter against the simulated timers and virtual clock
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "critical_section.h"
+#include "high_precision_counter.hpp"
+#include "interrupt_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+
+using namespace PSR;
+
+namespace
+{
+
+TIM_TypeDef lowerTim;
+TIM_TypeDef upperTim;
+HighPrecisionCounter* counter = nullptr;
+
+void CounterIrqHandler()
+{
+	counter->Update(lowerTim.SR);
+}
+
+/// @brief The number of register reads left before the lower timer is overflowed, or negative once it has been
+int readsBeforeOverflow = -1;
+/// @brief The number of times the lower timer is overflowed, one read after another
+int overflowsLeft = 0;
+/// @brief The last lower timer count before it overflows
+uint32_t lastCount = 0;
+
+/// @brief Overflow the lower timer right before a chosen register read, the most adversarial point of a read sequence
+/// @remark The timer is moved forward to two ticks before the end of its period and advanced by two
+void OverflowBeforeRead(const volatile void* reg)
+{
+	(void)reg;
+	if (readsBeforeOverflow < 0 || readsBeforeOverflow-- > 0 || overflowsLeft == 0)
+		return;
+
+	lowerTim.CNT.Value = lastCount - 1;
+	HOST_TIM_Advance(&lowerTim, 2);
+	overflowsLeft--;
+	readsBeforeOverflow = overflowsLeft > 0 ? 0 : -1;
+}
+
+class HighPrecisionCounterTest : public ::testing::Test
+{
+  protected:
+	void SetUp() override
+	{
+		lowerTim = TIM_TypeDef {};
+		upperTim = TIM_TypeDef {};
+		HOST_RCC_SetClocks(84000000, RCC_HCLK_DIV2, RCC_HCLK_DIV1);
+		// The lower timer is attached first, so it is ITR0 of the upper timer
+		HOST_TIM_Attach(&lowerTim, CounterIrqHandler);
+		HOST_TIM_Attach(&upperTim, nullptr);
+	}
+
+	void TearDown() override
+	{
+		HOST_TIM_Detach(&lowerTim);
+		HOST_TIM_Detach(&upperTim);
+		counter = nullptr;
+	}
+};
+
+TEST_F(HighPrecisionCounterTest, CountsMicroseconds)
+{
+	HighPrecisionCounter single(&lowerTim, 1000);
+	counter = &single;
+	ASSERT_TRUE(single.Init());
+
+	uint64_t start = single.GetCount();
+	HAL_Delay(25);
+
+	EXPECT_EQ(single.GetCount() - start, 25000u);
+}
+
+TEST_F(HighPrecisionCounterTest, CascadedCountsMicroseconds)
+{
+	HighPrecisionCounter cascaded(&lowerTim, &upperTim, TIM_TS_ITR0);
+	counter = &cascaded;
+	ASSERT_TRUE(cascaded.Init());
+
+	// The prescaler is in use from the start instead of after the first overflow of the lower timer
+	EXPECT_EQ(cascaded.GetCount(), 0u);
+	HAL_Delay(25);
+	EXPECT_EQ(cascaded.GetCount(), 25000u);
+}
+
+TEST_F(HighPrecisionCounterTest, CascadedCarriesIntoTheUpperTimer)
+{
+	HighPrecisionCounter cascaded(&lowerTim, &upperTim, TIM_TS_ITR0);
+	counter = &cascaded;
+	ASSERT_TRUE(cascaded.Init());
+
+	lowerTim.CNT.Value = 0xFFFFFFFF - 10;
+	HAL_Delay(1);
+
+	EXPECT_EQ(upperTim.CNT.Value, 1u);
+	EXPECT_EQ(cascaded.GetCount(), (1ull << 32) + 1000 - 11);
+}
+
+TEST_F(HighPrecisionCounterTest, DelayedCallbacksRunOnTime)
+{
+	HighPrecisionCounter single(&lowerTim, 1000);
+	counter = &single;
+	ASSERT_TRUE(single.Init());
+
+	static uint64_t firedAt[4];
+	static size_t fired = 0;
+	const uint64_t delays[] = { 1, 999, 2500, 12345 };
+
+	uint64_t start = single.GetCount();
+	for (uint64_t delay : delays)
+		ASSERT_TRUE(single.AddDelayedCallbackMicroseconds(delay, [&single] { firedAt[fired++] = single.GetCount(); }).IsValid());
+
+	// Advance a microsecond at a time so each callback is drained as soon as it is queued
+	for (int i = 0; i < 13000; i++)
+	{
+		HOST_AdvanceTime(84);
+		InterruptQueue::HandleQueue();
+	}
+
+	ASSERT_EQ(fired, 4u);
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(firedAt[i] - start, delays[i]);
+}
+
+/// @brief Reads with the lower timer overflowing part way through, in single timer (false) or cascaded (true) mode,
+/// with the update interrupt able to run (false) or masked (true)
+class HighPrecisionCounterTearTest : public HighPrecisionCounterTest, public ::testing::WithParamInterface<std::tuple<bool, bool>>
+{
+  protected:
+	static constexpr uint32_t Precision = 1000;
+
+	void TearDown() override
+	{
+		HOST_SetRegisterReadHook(nullptr);
+		HighPrecisionCounterTest::TearDown();
+	}
+
+	static bool IsCascaded() { return std::get<0>(GetParam()); }
+	static bool IsMasked() { return std::get<1>(GetParam()); }
+
+	/// @brief The lower timer counts in one period
+	static uint64_t Period() { return IsCascaded() ? 1ull << 32 : Precision; }
+};
+
+TEST_P(HighPrecisionCounterTearTest, OverflowBeforeEachReadNeverGoesBackwards)
+{
+	HighPrecisionCounter single(&lowerTim, Precision);
+	HighPrecisionCounter cascaded(&lowerTim, &upperTim, TIM_TS_ITR0);
+	counter = IsCascaded() ? &cascaded : &single;
+	ASSERT_TRUE(counter->Init());
+	HAL_Delay(3);
+	lastCount = (uint32_t)(Period() - 1);
+
+	// Past the last read of a read sequence nothing is injected, so every read point is covered
+	for (int readIndex = 0; readIndex < 8; readIndex++)
+	{
+		SCOPED_TRACE(readIndex);
+
+		uint32_t primask = IsMasked() ? EnterCriticalSection() : 0;
+
+		lowerTim.CNT.Value = lastCount - 1;
+		uint64_t before    = counter->GetRawCount();
+
+		readsBeforeOverflow = readIndex;
+		overflowsLeft       = 1;
+		HOST_SetRegisterReadHook(OverflowBeforeRead);
+		uint64_t during = counter->GetRawCount();
+		HOST_SetRegisterReadHook(nullptr);
+
+		uint64_t after = counter->GetRawCount();
+		EXPECT_LE(before, during);
+		EXPECT_LE(during, after);
+
+		bool overflowed = overflowsLeft == 0;
+		if (readIndex < 3)
+		{
+			EXPECT_TRUE(overflowed);
+		}
+		EXPECT_EQ(after, overflowed ? before + 2 : before);
+
+		// The interrupt the overflow raised runs now, and does not change the count
+		if (IsMasked())
+			ExitCriticalSection(primask);
+		EXPECT_EQ(counter->GetRawCount(), after);
+	}
+}
+
+TEST_P(HighPrecisionCounterTearTest, OverflowBeforeEveryReadNeverGoesBackwards)
+{
+	// A single timer with its interrupt masked loses a second overflow to the one hardware flag, the cascaded count does not
+	if (IsMasked() && !IsCascaded())
+		GTEST_SKIP();
+
+	uint32_t primask = IsMasked() ? EnterCriticalSection() : 0;
+
+	HighPrecisionCounter single(&lowerTim, Precision);
+	HighPrecisionCounter cascaded(&lowerTim, &upperTim, TIM_TS_ITR0);
+	counter = IsCascaded() ? &cascaded : &single;
+	ASSERT_TRUE(counter->Init());
+	lastCount = (uint32_t)(Period() - 1);
+
+	lowerTim.CNT.Value = lastCount - 1;
+	uint64_t before    = counter->GetRawCount();
+
+	// An overflow before each of the next reads, so every retry of the read sees another one
+	readsBeforeOverflow = 0;
+	overflowsLeft       = 6;
+	HOST_SetRegisterReadHook(OverflowBeforeRead);
+	uint64_t during = counter->GetRawCount();
+	HOST_SetRegisterReadHook(nullptr);
+
+	uint64_t after = counter->GetRawCount();
+	EXPECT_LE(before, during);
+	EXPECT_LE(during, after);
+	EXPECT_EQ(overflowsLeft, 0);
+	// Each overflow finishes a period, the first from two ticks before its end
+	EXPECT_EQ(after, before + 5 * Period() + 2);
+
+	if (IsMasked())
+		ExitCriticalSection(primask);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, HighPrecisionCounterTearTest, ::testing::Combine(::testing::Bool(), ::testing::Bool()),
+                         [](const ::testing::TestParamInfo<std::tuple<bool, bool>>& info)
+                         {
+	                         return std::string(std::get<0>(info.param) ? "Cascaded" : "Single") +
+	                                (std::get<1>(info.param) ? "Masked" : "Unmasked");
+                         });
+
+} // namespace
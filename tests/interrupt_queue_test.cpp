@@ -0,0 +1,327 @@
+/**
+ * @file interrupt_queue_test.cpp
+ * @author Purdue Solar Racing
+ * @brief Host tests of InterruptQueue, with threads standing in for interrupts and a simulated timer as the time source
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "high_precision_counter.hpp"
+#include "interrupt_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+std::vector<int> order;
+
+class InterruptQueueTest : public ::testing::Test
+{
+  protected:
+	void SetUp() override
+	{
+		InterruptQueue::HandleQueue();
+		InterruptQueue::ResetStatistics();
+		order.clear();
+	}
+};
+
+TEST_F(InterruptQueueTest, RunsEachLaneInFifoOrder)
+{
+	for (int i = 0; i < 5; i++)
+		ASSERT_TRUE(InterruptQueue::AddInterrupt([i] { order.push_back(i); }));
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_EQ(order, (std::vector<int> { 0, 1, 2, 3, 4 }));
+	EXPECT_EQ(InterruptQueue::GetPending(), 0u);
+}
+
+TEST_F(InterruptQueueTest, RunsHigherPrioritiesFirst)
+{
+	InterruptQueue::AddInterrupt([] { order.push_back(0); }, InterruptPriority::Low);
+	InterruptQueue::AddInterrupt([] { order.push_back(1); }, InterruptPriority::Normal);
+	InterruptQueue::AddInterrupt([] { order.push_back(2); }, InterruptPriority::High);
+	InterruptQueue::AddInterrupt([] { order.push_back(3); }, InterruptPriority::Low);
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_EQ(order, (std::vector<int> { 2, 1, 0, 3 }));
+}
+
+TEST_F(InterruptQueueTest, DropsAndCountsWhenFull)
+{
+	for (size_t i = 0; i < InterruptQueue::GetDepth(); i++)
+		ASSERT_TRUE(InterruptQueue::AddInterrupt([] {}));
+
+	EXPECT_FALSE(InterruptQueue::AddInterrupt([] {}));
+
+	InterruptQueue::Statistics statistics = InterruptQueue::GetStatistics(InterruptPriority::Normal);
+	EXPECT_EQ(statistics.Enqueued, InterruptQueue::GetDepth());
+	EXPECT_EQ(statistics.Dropped, 1u);
+	EXPECT_EQ(statistics.HighWatermark, InterruptQueue::GetDepth());
+
+	InterruptQueue::HandleQueue();
+	EXPECT_EQ(InterruptQueue::GetPending(), 0u);
+	EXPECT_TRUE(InterruptQueue::AddInterrupt([] {}));
+}
+
+TEST_F(InterruptQueueTest, CallbacksQueuedWhileDrainingRunOnTheNextDrain)
+{
+	static int runs = 0;
+	InterruptQueue::AddInterrupt([] {
+		runs++;
+		InterruptQueue::AddInterrupt([] { runs++; });
+	});
+
+	InterruptQueue::HandleQueue();
+	EXPECT_EQ(runs, 1);
+	EXPECT_EQ(InterruptQueue::GetPending(), 1u);
+
+	InterruptQueue::HandleQueue();
+	EXPECT_EQ(runs, 2);
+}
+
+TEST_F(InterruptQueueTest, HigherPriorityCallbacksQueuedWhileDrainingRunFirst)
+{
+	// The first low priority callback stands in for an interrupt that queues urgent work during the drain
+	InterruptQueue::AddInterrupt([] {
+		order.push_back(0);
+		InterruptQueue::AddInterrupt([] { order.push_back(1); }, InterruptPriority::High);
+	}, InterruptPriority::Low);
+	InterruptQueue::AddInterrupt([] { order.push_back(2); }, InterruptPriority::Low);
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_EQ(order, (std::vector<int> { 0, 1, 2 }));
+}
+
+TEST_F(InterruptQueueTest, SelfQueueingCallbackCannotStarveTheMainLoop)
+{
+	static int runs        = 0;
+	static bool requeueing = true;
+	static void (*requeue)() = [] {
+		runs++;
+		if (requeueing)
+			InterruptQueue::AddInterrupt(requeue, InterruptPriority::High);
+	};
+	InterruptQueue::AddInterrupt([] { order.push_back(0); }, InterruptPriority::Low);
+	InterruptQueue::AddInterrupt(requeue, InterruptPriority::High);
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_LE(runs, (int)InterruptQueue::GetDepth() + 1);
+	EXPECT_EQ(order, (std::vector<int> { 0 }));
+	EXPECT_EQ(InterruptQueue::GetPending(InterruptPriority::High), 1u);
+
+	requeueing = false;
+	InterruptQueue::HandleQueue();
+}
+
+/// @brief Producers on every lane enqueue as fast as they can while the main thread drains, nothing may be lost or reordered
+TEST_F(InterruptQueueTest, ConcurrentProducersLoseNothing)
+{
+	constexpr uint32_t Producers          = 6;
+	constexpr uint32_t CallbacksPerThread = 200000;
+
+	static uint32_t received[Producers];
+	static uint32_t outOfOrder = 0;
+
+	std::atomic<uint32_t> drops { 0 };
+	std::atomic<bool> start { false };
+
+	std::vector<std::thread> threads;
+	for (uint32_t producer = 0; producer < Producers; producer++)
+	{
+		threads.emplace_back([producer, &drops, &start] {
+			InterruptPriority priority = (InterruptPriority)(producer % InterruptQueue::PriorityCount);
+			while (!start.load())
+			{}
+
+			for (uint32_t sequence = 0; sequence < CallbacksPerThread;)
+			{
+				bool added = InterruptQueue::AddInterrupt([producer, sequence] {
+					if (received[producer] != sequence)
+						outOfOrder++;
+					received[producer] = sequence + 1;
+				}, priority);
+
+				if (added)
+				{
+					sequence++;
+				}
+				else
+				{
+					// Let the main thread drain, the host may have fewer cores than threads
+					drops.fetch_add(1);
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	start.store(true);
+
+	uint32_t total = 0;
+	while (total < Producers * CallbacksPerThread)
+	{
+		InterruptQueue::HandleQueue();
+		std::this_thread::yield();
+
+		total = 0;
+		for (uint32_t count : received)
+			total += count;
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_EQ(outOfOrder, 0u);
+	for (uint32_t count : received)
+		EXPECT_EQ(count, CallbacksPerThread);
+
+	uint32_t enqueued = 0;
+	uint32_t dropped  = 0;
+	for (size_t i = 0; i < InterruptQueue::PriorityCount; i++)
+	{
+		InterruptQueue::Statistics statistics = InterruptQueue::GetStatistics((InterruptPriority)i);
+		enqueued += statistics.Enqueued;
+		dropped += statistics.Dropped;
+		EXPECT_LE(statistics.HighWatermark, InterruptQueue::GetDepth());
+	}
+
+	EXPECT_EQ(enqueued, Producers * CallbacksPerThread);
+	EXPECT_EQ(dropped, drops.load());
+	EXPECT_EQ(InterruptQueue::GetPending(), 0u);
+}
+
+TIM_TypeDef lowerTim;
+TIM_TypeDef upperTim;
+HighPrecisionCounter* counter = nullptr;
+
+void CounterIrqHandler()
+{
+	counter->Update(lowerTim.SR);
+}
+
+/// @brief A cascaded counter on the simulated timers as the time source, it reads zero until the virtual clock moves
+class InterruptQueueTimingTest : public InterruptQueueTest
+{
+  protected:
+	std::unique_ptr<HighPrecisionCounter> timeSource;
+
+	void SetUp() override
+	{
+		InterruptQueueTest::SetUp();
+
+		lowerTim = TIM_TypeDef {};
+		upperTim = TIM_TypeDef {};
+		HOST_RCC_SetClocks(84000000, RCC_HCLK_DIV2, RCC_HCLK_DIV1);
+		HOST_TIM_Attach(&lowerTim, CounterIrqHandler);
+		HOST_TIM_Attach(&upperTim, nullptr);
+
+		timeSource = std::make_unique<HighPrecisionCounter>(&lowerTim, &upperTim, TIM_TS_ITR0);
+		counter    = timeSource.get();
+		ASSERT_TRUE(timeSource->Init());
+		InterruptQueue::SetTimeSource(timeSource.get());
+	}
+
+	void TearDown() override
+	{
+		InterruptQueue::SetTimeSource(nullptr);
+		InterruptQueue::HandleQueue();
+		InterruptQueue::ResetStatistics();
+		HOST_TIM_Detach(&lowerTim);
+		HOST_TIM_Detach(&upperTim);
+		counter = nullptr;
+	}
+};
+
+TEST_F(InterruptQueueTimingTest, DrainStopsOnceTheBudgetIsSpent)
+{
+	// Each callback takes a millisecond, so the check after the third finds 3000 us spent of the 2500 us budget
+	for (int i = 0; i < 5; i++)
+		InterruptQueue::AddInterrupt([i] {
+			order.push_back(i);
+			HAL_Delay(1);
+		});
+
+	InterruptQueue::HandleQueue(2500);
+	EXPECT_EQ(order, (std::vector<int> { 0, 1, 2 }));
+	EXPECT_EQ(InterruptQueue::GetPending(), 2u);
+
+	InterruptQueue::HandleQueue();
+	EXPECT_EQ(order, (std::vector<int> { 0, 1, 2, 3, 4 }));
+}
+
+TEST_F(InterruptQueueTimingTest, DrainRunsOneCallbackWhateverTheBudget)
+{
+	for (int i = 0; i < 3; i++)
+		InterruptQueue::AddInterrupt([i] {
+			order.push_back(i);
+			HAL_Delay(1);
+		});
+
+	InterruptQueue::HandleQueue(0);
+	EXPECT_EQ(order, (std::vector<int> { 0 }));
+
+	InterruptQueue::HandleQueue(1);
+	EXPECT_EQ(order, (std::vector<int> { 0, 1 }));
+	EXPECT_EQ(InterruptQueue::GetPending(), 1u);
+}
+
+TEST_F(InterruptQueueTimingTest, RecordsLatencyForEachLane)
+{
+	// The first callback is queued while the time source still reads zero, its latency counts like any other
+	ASSERT_EQ(timeSource->GetCount(), 0u);
+	InterruptQueue::AddInterrupt([] {}, InterruptPriority::High);
+	HAL_Delay(1);
+	InterruptQueue::AddInterrupt([] {}, InterruptPriority::High);
+	InterruptQueue::AddInterrupt([] {}, InterruptPriority::Normal);
+	HAL_Delay(1);
+	InterruptQueue::AddInterrupt([] {}, InterruptPriority::Low);
+	HAL_Delay(2);
+
+	InterruptQueue::HandleQueue();
+
+	InterruptQueue::Statistics high = InterruptQueue::GetStatistics(InterruptPriority::High);
+	EXPECT_EQ(high.Run, 2u);
+	EXPECT_EQ(high.MinLatency, 3000u);
+	EXPECT_EQ(high.MaxLatency, 4000u);
+	EXPECT_EQ(high.GetMeanLatency(), 3500u);
+
+	InterruptQueue::Statistics normal = InterruptQueue::GetStatistics(InterruptPriority::Normal);
+	EXPECT_EQ(normal.Run, 1u);
+	EXPECT_EQ(normal.MinLatency, 3000u);
+	EXPECT_EQ(normal.MaxLatency, 3000u);
+
+	InterruptQueue::Statistics low = InterruptQueue::GetStatistics(InterruptPriority::Low);
+	EXPECT_EQ(low.Run, 1u);
+	EXPECT_EQ(low.MinLatency, 2000u);
+	EXPECT_EQ(low.MaxLatency, 2000u);
+}
+
+TEST_F(InterruptQueueTimingTest, CallbacksQueuedWithoutATimeSourceAreNotTimed)
+{
+	InterruptQueue::SetTimeSource(nullptr);
+	InterruptQueue::AddInterrupt([] {});
+	InterruptQueue::SetTimeSource(timeSource.get());
+	HAL_Delay(1);
+
+	InterruptQueue::HandleQueue();
+
+	EXPECT_EQ(InterruptQueue::GetStatistics(InterruptPriority::Normal).Run, 0u);
+}
+
+} // namespace
@@ -0,0 +1,38 @@
+/**
+ * @file register_field_compile_fail.cpp
+ * @author Purdue Solar Racing
+ * @brief Misuses of the register fields that must not compile, each case is built on its own and expected to fail
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "timer_registers.hpp"
+
+using namespace PSR;
+
+void CompileFail(TIM_TypeDef* tim)
+{
+	(void)tim;
+
+#if REGISTER_FIELD_CASE == 0
+	// Control case, must compile so that a broken build is not mistaken for the expected failures
+	writeRegister(tim, Tim::CR1::CEN::Set | Tim::CR1::CKD::Of<3>());
+#elif REGISTER_FIELD_CASE == 1
+	// A constant too wide for its field
+	writeRegister(tim, Tim::CR1::CKD::Of<4>());
+#elif REGISTER_FIELD_CASE == 2
+	// A run time value that is constant evaluated and too wide for its field
+	constexpr auto value = Tim::CR1::CKD::Of(4);
+	(void)value;
+#elif REGISTER_FIELD_CASE == 3
+	// Fields of two registers
+	writeRegister(tim, Tim::CR1::CEN::Set | Tim::DIER::UIE::Set);
+#elif REGISTER_FIELD_CASE == 4
+	// The same field twice
+	writeRegister(tim, Tim::CR1::CEN::Set | Tim::CR1::CEN::Clear);
+#elif REGISTER_FIELD_CASE == 5
+	// A field past the end of the register
+	(void)Field<Tim::CR1::Register, 30, 4>::Mask;
+#endif
+}
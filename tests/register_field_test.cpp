@@ -0,0 +1,200 @@
+/**
+ * @file register_field_test.cpp
+ * @author Purdue Solar Racing
+ * @brief Host tests of the register field accessors against counted and simulated registers
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "register_field.hpp"
+#include "timer_registers.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace PSR;
+
+namespace
+{
+
+/// @brief A register that counts its reads and writes, so a test can check how many accesses an accessor makes
+struct CountingRegister
+{
+	uint32_t Value;
+	mutable size_t Reads;
+	size_t Writes;
+
+	operator uint32_t() const volatile
+	{
+		Reads = Reads + 1;
+		return Value;
+	}
+
+	void operator=(uint32_t value) volatile
+	{
+		Writes = Writes + 1;
+		Value = value;
+	}
+};
+
+struct Peripheral
+{
+	CountingRegister Control;
+	CountingRegister Status;
+	CountingRegister Data;
+};
+
+// A control register with reserved bits, a flag register and a data register whose 16 bits are all given by one field
+using Control = Register<Peripheral, &Peripheral::Control, 0x00000010>;
+using Enable  = Field<Control, 0, 1>;
+using Mode    = Field<Control, 4, 2>;
+using Divider = Field<Control, 8, 8>;
+
+using Status = Register<Peripheral, &Peripheral::Status>;
+using Ready  = Field<Status, 0, 1>;
+using Error  = Field<Status, 1, 1>;
+
+using Data = Register<Peripheral, &Peripheral::Data, 0, 0x0000FFFF>;
+using Word = Field<Data, 0, 16>;
+
+// The masks and values are worked out at compile time, so each accessor is one constant and one or two register accesses
+static_assert(Divider::Mask == 0x0000FF00);
+static_assert(Word::Max == 0xFFFF);
+static_assert(decltype(Enable::Set | Mode::Of<2>() | Divider::Of<0x3C>())::FieldMask == 0x0000FF31);
+static_assert((Enable::Set | Mode::Of<2>() | Divider::Of<0x3C>()).GetBits() == 0x00003C21);
+static_assert((Mode::Clear | Enable::Set).GetBits() == 0x00000001);
+static_assert(Divider::Get(RegisterValue<Control>(0x12345678)) == 0x56);
+static_assert(Mode::IsSet(RegisterValue<Control>(0x30)) && !Mode::IsSet(RegisterValue<Control>(0x10)));
+static_assert(decltype(Tim::CR1::CEN::Set | Tim::CR1::ARPE::Set)::FieldMask == (TIM_CR1_CEN | TIM_CR1_ARPE));
+static_assert(Tim::CR1::CKD::Mask == 0x00000300);
+static_assert(Tim::SR::CC4IF::Mask == TIM_SR_CC4IF);
+
+class RegisterFieldTest : public ::testing::Test
+{
+  protected:
+	Peripheral peripheral = {};
+};
+
+TEST_F(RegisterFieldTest, WriteSetsTheOtherBitsToTheirResetValues)
+{
+	peripheral.Control.Value = 0xFFFFFFFF;
+	writeRegister(&peripheral, Enable::Set | Divider::Of<0x3C>());
+
+	EXPECT_EQ(peripheral.Control.Value, 0x00003C11u);
+	EXPECT_EQ(peripheral.Control.Reads, 0u);
+	EXPECT_EQ(peripheral.Control.Writes, 1u);
+}
+
+TEST_F(RegisterFieldTest, ModifyKeepsTheOtherFieldsWithOneReadAndOneWrite)
+{
+	peripheral.Control.Value = 0xA5A5A5A5;
+	modifyRegister(&peripheral, Mode::Of<1>() | Divider::Of<0x42>());
+
+	EXPECT_EQ(peripheral.Control.Value, 0xA5A54295u);
+	EXPECT_EQ(peripheral.Control.Reads, 1u);
+	EXPECT_EQ(peripheral.Control.Writes, 1u);
+}
+
+TEST_F(RegisterFieldTest, ModifyOfEveryImplementedBitDoesNotRead)
+{
+	peripheral.Data.Value = 0x1234;
+	modifyRegister(&peripheral, Word::Of<0xBEEF>());
+
+	EXPECT_EQ(peripheral.Data.Value, 0xBEEFu);
+	EXPECT_EQ(peripheral.Data.Reads, 0u);
+	EXPECT_EQ(peripheral.Data.Writes, 1u);
+}
+
+TEST_F(RegisterFieldTest, RuntimeValuesAreTruncatedToTheField)
+{
+	volatile uint32_t divider = 0x1FF;
+	writeRegister(&peripheral, Divider::Of(divider));
+
+	EXPECT_EQ(peripheral.Control.Value, 0x0000FF10u);
+}
+
+TEST_F(RegisterFieldTest, ClearFlagsWritesZeroOnlyToTheGivenFlags)
+{
+	peripheral.Status.Value = 0x3;
+	clearRegisterFlags(&peripheral, Error::Set);
+
+	EXPECT_EQ(peripheral.Status.Value, ~Error::Mask);
+	EXPECT_EQ(peripheral.Status.Reads, 0u);
+	EXPECT_EQ(peripheral.Status.Writes, 1u);
+}
+
+TEST_F(RegisterFieldTest, ReadGetsEachFieldWithOneRead)
+{
+	peripheral.Control.Value = 0x00007721;
+	RegisterValue<Control> value = Control::Read(&peripheral);
+
+	EXPECT_EQ(Enable::Get(value), 1u);
+	EXPECT_EQ(Mode::Get(value), 2u);
+	EXPECT_EQ(Divider::Get(value), 0x77u);
+	EXPECT_EQ(peripheral.Control.Reads, 1u);
+
+	EXPECT_EQ(Divider::Read(&peripheral), 0x77u);
+	EXPECT_EQ(peripheral.Control.Reads, 2u);
+}
+
+TEST_F(RegisterFieldTest, ResetRegisterWritesTheResetValue)
+{
+	peripheral.Control.Value = 0xFFFFFFFF;
+	Control::ResetRegister(&peripheral);
+
+	EXPECT_EQ(peripheral.Control.Value, Control::Reset);
+	EXPECT_EQ(peripheral.Control.Reads, 0u);
+}
+
+/// @brief The timer register fields against a simulated timer, whose status flags are cleared by writing zero
+class TimerRegisterTest : public ::testing::Test
+{
+  protected:
+	static inline size_t reads = 0;
+
+	TIM_TypeDef tim = {};
+
+	static void CountRead(const volatile void* reg)
+	{
+		(void)reg;
+		reads++;
+	}
+
+	void SetUp() override
+	{
+		reads = 0;
+		HOST_TIM_Attach(&tim, nullptr);
+		HOST_SetRegisterReadHook(CountRead);
+	}
+
+	void TearDown() override
+	{
+		HOST_SetRegisterReadHook(nullptr);
+		HOST_TIM_Detach(&tim);
+	}
+};
+
+TEST_F(TimerRegisterTest, WriteAndModifyControlRegister)
+{
+	writeRegister(&tim, Tim::CR1::CEN::Set | Tim::CR1::ARPE::Set | Tim::CR1::CKD::Of<2>());
+	EXPECT_EQ(reads, 0u);
+	EXPECT_EQ(tim.CR1.Value, TIM_CR1_CEN | TIM_CR1_ARPE | 0x00000200u);
+
+	modifyRegister(&tim, Tim::CR1::CEN::Clear);
+	EXPECT_EQ(reads, 1u);
+	EXPECT_EQ(tim.CR1.Value, TIM_CR1_ARPE | 0x00000200u);
+
+	EXPECT_EQ(Tim::CR1::CKD::Read(&tim), 2u);
+	EXPECT_FALSE(Tim::CR1::CEN::IsSet(Tim::CR1::Register::Read(&tim)));
+}
+
+TEST_F(TimerRegisterTest, ClearFlagsLeavesTheOtherFlagsRaised)
+{
+	tim.SR.Value = TIM_SR_UIF | TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF;
+	clearRegisterFlags(&tim, Tim::SR::UIF::Set | Tim::SR::CC2IF::Set);
+
+	EXPECT_EQ(reads, 0u);
+	EXPECT_EQ(tim.SR.Value, TIM_SR_CC1IF | TIM_SR_CC3IF | TIM_SR_CC4IF);
+}
+
+} // namespace
@@ -0,0 +1,192 @@
+/**
+ * @file scheduler_test.cpp
+ * @author Purdue Solar Racing
+ * @brief Host tests of the ticked and tickless Scheduler against a simulated timer
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "scheduler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+using namespace PSR;
+
+namespace
+{
+
+constexpr uint32_t Frequency = 1000;
+constexpr uint32_t Precision = 32;
+
+TIM_TypeDef tim;
+Scheduler* scheduler = nullptr;
+size_t interrupts    = 0;
+
+/// @brief The task that ran and the scheduler tick it ran on, in the order the tasks ran
+std::vector<std::pair<int, uint32_t>> runs;
+
+void SchedulerIrqHandler()
+{
+	if ((tim.SR.Value & TIM_SR_UIF) == 0)
+		return;
+
+	tim.SR = ~TIM_SR_UIF;
+	interrupts++;
+	scheduler->Update();
+}
+
+template <int Id>
+void Record()
+{
+	runs.emplace_back(Id, scheduler->GetCounter());
+}
+
+class SchedulerTest : public ::testing::TestWithParam<bool>
+{
+  protected:
+	void SetUp() override
+	{
+		tim = TIM_TypeDef {};
+		runs.clear();
+		interrupts = 0;
+		HOST_RCC_SetClocks(16000000, RCC_HCLK_DIV1, RCC_HCLK_DIV1);
+		HOST_TIM_Attach(&tim, SchedulerIrqHandler);
+	}
+
+	void TearDown() override
+	{
+		InterruptQueue::HandleQueue();
+		HOST_TIM_Detach(&tim);
+		scheduler = nullptr;
+	}
+
+	/// @brief Advance the timer one scheduler tick at a time, running the deferred tasks after each
+	static void RunTicks(uint32_t ticks)
+	{
+		for (uint32_t i = 0; i < ticks; i++)
+		{
+			HOST_TIM_Advance(&tim, Precision);
+			InterruptQueue::HandleQueue();
+		}
+	}
+};
+
+/// @brief Run the same task set in ticked and tickless mode and return the runs
+std::vector<std::pair<int, uint32_t>> RunTaskSet(bool tickless, size_t& interruptCount)
+{
+	tim = TIM_TypeDef {};
+	runs.clear();
+	interrupts = 0;
+	HOST_TIM_Attach(&tim, SchedulerIrqHandler);
+
+	Scheduler instance(&tim, Frequency, Precision, 0x7FFFFFFF, tickless);
+	scheduler = &instance;
+	EXPECT_TRUE(instance.Init());
+	instance.AddTask(Record<0>, 100u);
+	instance.AddTask(Record<1>, 7u, 3u);
+
+	for (uint32_t tick = 0; tick < 6030; tick++)
+	{
+		HOST_TIM_Advance(&tim, Precision);
+		InterruptQueue::HandleQueue();
+
+		// Added in the middle of long tickless periods, so the timer has to be pulled in
+		if (tick == 5000)
+			instance.AddTask(Record<2>, 0u, instance.GetCounter() + 13);
+		if (tick == 6000)
+			instance.AddTask(Record<3>, 3u, 0u);
+		if (tick == 6010)
+			instance.Pause();
+		if (tick == 6020)
+			instance.Resume();
+	}
+
+	HOST_TIM_Detach(&tim);
+	scheduler      = nullptr;
+	interruptCount = interrupts;
+	return runs;
+}
+
+TEST(SchedulerModesTest, TicklessRunsTheSameTasksOnTheSameTicks)
+{
+	HOST_RCC_SetClocks(16000000, RCC_HCLK_DIV1, RCC_HCLK_DIV1);
+
+	size_t tickedInterrupts   = 0;
+	size_t ticklessInterrupts = 0;
+	std::vector<std::pair<int, uint32_t>> ticked   = RunTaskSet(false, tickedInterrupts);
+	std::vector<std::pair<int, uint32_t>> tickless = RunTaskSet(true, ticklessInterrupts);
+
+	ASSERT_FALSE(ticked.empty());
+	EXPECT_EQ(tickless, ticked);
+	EXPECT_EQ(tickedInterrupts, 6030u);
+	// The 7 tick task sets the pace, about one interrupt per 7 ticks instead of one per tick
+	EXPECT_LT(ticklessInterrupts, tickedInterrupts / 6);
+}
+
+TEST_P(SchedulerTest, OneShotTaskRunsOnItsTick)
+{
+	Scheduler instance(&tim, Frequency, Precision, 0x7FFFFFFF, GetParam());
+	scheduler = &instance;
+	ASSERT_TRUE(instance.Init());
+
+	RunTicks(250);
+	uint32_t due = instance.GetCounter() + 40;
+	instance.AddTask(Record<0>, 0u, due);
+	RunTicks(100);
+
+	ASSERT_EQ(runs.size(), 1u);
+	EXPECT_EQ(runs[0].second, due);
+	EXPECT_FALSE(instance.GetTaskEnabled(0));
+}
+
+TEST_P(SchedulerTest, IdleTimerOnlyInterruptsWhenATaskIsDue)
+{
+	Scheduler instance(&tim, Frequency, Precision, 0x7FFFFFFF, GetParam());
+	scheduler = &instance;
+	ASSERT_TRUE(instance.Init());
+	instance.AddTask(Record<0>, 500u);
+
+	RunTicks(5000);
+
+	ASSERT_EQ(runs.size(), 10u);
+	for (size_t i = 0; i < runs.size(); i++)
+		EXPECT_EQ(runs[i].second, 500 * (i + 1));
+
+	if (GetParam())
+		EXPECT_LE(interrupts, runs.size() + 1);
+	else
+		EXPECT_EQ(interrupts, 5000u);
+}
+
+TEST_P(SchedulerTest, TaskEnabledLateRunsOnTheNextTick)
+{
+	Scheduler instance(&tim, Frequency, Precision, 0x7FFFFFFF, GetParam());
+	scheduler = &instance;
+	ASSERT_TRUE(instance.Init());
+	size_t task = instance.AddTask(Record<0>, 10u);
+
+	// Disabled and enabled again between two runs
+	RunTicks(35);
+	instance.DisableTask(task);
+	RunTicks(3);
+	instance.EnableTask(task);
+	RunTicks(17);
+
+	// Disabled over the tick at 60 and enabled 3 ticks later, which is inside the late window
+	instance.DisableTask(task);
+	RunTicks(8);
+	instance.EnableTask(task);
+	RunTicks(12);
+
+	std::vector<std::pair<int, uint32_t>> expected = { { 0, 10 }, { 0, 20 }, { 0, 30 }, { 0, 40 }, { 0, 50 }, { 0, 64 }, { 0, 74 } };
+	EXPECT_EQ(runs, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, SchedulerTest, ::testing::Values(false, true),
+                         [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "Tickless" : "Ticked"; });
+
+} // namespace
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+Decode the binary records written by PSR::DeferredLog back into text.
+
+The format strings are read from the `.log_strings` section of the firmware ELF file,
+the records are read from a capture of the log output, for example a dump of the debug UART.
+
+Usage: decode_log.py firmware.elf capture.bin [--clock HZ]
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x4C470000
+MAGIC_MASK = 0xFFFF0000
+HEADER_WORDS = 4
+
+INT32 = 1
+INT64 = 2
+DOUBLE = 3
+STRING = 4
+
+SPECIFIER = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcspaA%])")
+
+
+def read_log_strings(path):
+    """Return the `.log_strings` section as (address, bytes)."""
+    with open(path, "rb") as file:
+        elf = file.read()
+
+    if elf[:4] != b"\x7fELF":
+        raise ValueError(f"{path} is not an ELF file")
+
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        header = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        header = endian + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+
+    for name, _, _, address, offset, size, *_ in sections:
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] == b".log_strings":
+            return address, elf[offset:offset + size]
+
+    raise ValueError(f"{path} has no .log_strings section")
+
+
+def read_records(data):
+    """Yield the words of each record, skipping bytes until the next header."""
+    position = 0
+    while position + 4 * HEADER_WORDS <= len(data):
+        header, = struct.unpack_from("<I", data, position)
+        length = header & ~MAGIC_MASK
+        if (header & MAGIC_MASK) != MAGIC or length < HEADER_WORDS or position + 4 * length > len(data):
+            position += 1
+            continue
+
+        yield struct.unpack_from(f"<{length}I", data, position)
+        position += 4 * length
+
+
+def read_arguments(words, types):
+    arguments = []
+    index = HEADER_WORDS
+    while types != 0:
+        kind = types & 0xF
+        types >>= 4
+
+        if kind == INT32:
+            arguments.append(words[index])
+            index += 1
+        elif kind in (INT64, DOUBLE):
+            bits = words[index] | words[index + 1] << 32
+            arguments.append(struct.unpack("<d", struct.pack("<Q", bits))[0] if kind == DOUBLE else bits)
+            index += 2
+        elif kind == STRING:
+            size = words[index]
+            raw = struct.pack(f"<{(size + 3) // 4}I", *words[index + 1:index + 1 + (size + 3) // 4])
+            arguments.append(raw[:size].decode("utf-8", "replace"))
+            index += 1 + (size + 3) // 4
+        else:
+            raise ValueError(f"unknown argument type {kind}")
+
+    return arguments
+
+
+def render(fmt, arguments):
+    """Apply a C format string, converting integers to the signedness and width the specifier asks for."""
+    values = iter(arguments)
+
+    def replace(match):
+        flags, width, precision, length, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+
+        value = next(values, None)
+        if value is None:
+            return match.group(0)
+
+        bits = 64 if length in ("ll", "j") else 32
+        if isinstance(value, int):
+            value &= (1 << bits) - 1
+            if conversion in "di" and value >> (bits - 1):
+                value -= 1 << bits
+            if conversion == "c":
+                value = chr(value & 0xFF)
+            elif conversion == "p":
+                return f"0x{value:x}"
+            elif conversion in "eEfFgGaA":
+                value = float(value)
+        elif conversion in "diouxXc":
+            value = int(value)
+
+        conversion = {"i": "d", "u": "d", "a": "e", "A": "E", "F": "f"}.get(conversion, conversion)
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "") + conversion
+        return spec % value
+
+    return SPECIFIER.sub(replace, fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="The firmware ELF file the log was written by")
+    parser.add_argument("capture", nargs="?", help="The captured log bytes, read from stdin if omitted")
+    parser.add_argument("--clock", type=float, default=0, help="The core clock in Hertz, timestamps are printed in cycles if omitted")
+    args = parser.parse_args()
+
+    address, strings = read_log_strings(args.elf)
+
+    if args.capture is None:
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as file:
+            data = file.read()
+
+    for words in read_records(data):
+        _, format_address, timestamp, types = words[:HEADER_WORDS]
+
+        offset = format_address - (address & 0xFFFFFFFF)
+        if not 0 <= offset < len(strings):
+            print(f"<unknown format string 0x{format_address:08x}>")
+            continue
+
+        fmt = strings[offset:strings.index(b"\0", offset)].decode("utf-8", "replace")
+        text = render(fmt, read_arguments(words, types))
+        stamp = f"{timestamp / args.clock:12.6f}" if args.clock else f"{timestamp:10d}"
+        sys.stdout.write(f"[{stamp}] {text}")
+        if not text.endswith("\n"):
+            sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()